@@ -0,0 +1,65 @@
+#include "Barrett.h"
+
+Barrett::Barrett(const BigInt& modulus) : m(modulus), k((modulus.bitLength() + limb_bits - 1) / limb_bits) {
+    assert(modulus > 0);
+    mu = (BigInt(1) << (2 * k * limb_bits)) / m;
+}
+
+// q = floor(floor(x / B^(k-1)) * mu / B^(k+1)) is at most 2 below floor(x / m)
+BigInt Barrett::reduce(const BigInt& x) const {
+    if (x < 0) {
+        BigInt r = reduce(-x);
+        return r.isZero() ? r : m - r;
+    }
+    if (x.bitLength() > 2 * k * limb_bits) {
+        return x % m;
+    }
+    BigInt q = ((x >> ((k - 1) * limb_bits)) * mu) >> ((k + 1) * limb_bits);
+    BigInt r = x - q * m;
+    while (r >= m)
+        r -= m;
+    return r;
+}
+
+// Same steps on the limbs; only the low k + 1 limbs of x - q * m are ever formed (HAC 14.42)
+void Barrett::reduce_into(BigInt& dst, const BigInt& x, BigIntWorkspace& ws) const {
+    int nx = (int)x.z.size();
+    if (x.sign < 0 || nx > 2 * k) {
+        dst = reduce(x);
+        return;
+    }
+    if (BigInt::cmp_abs(x.z, m.z) < 0) {
+        if (&dst != &x)
+            dst = x;
+        return;
+    }
+
+    // q = floor(x / B^(k-1)) * mu / B^(k+1)
+    const limb* q1 = x.z.data() + (k - 1);
+    int n1 = nx - (k - 1), nmu = (int)mu.z.size();
+    int n3 = n1 + nmu - (k + 1);
+    int need = max(limbs_mul_scratch(n1, nmu), n3 > 0 ? limbs_mul_scratch(n3, k) : 0);
+    if ((int)ws.scratch.size() < need)
+        ws.scratch.resize(need);
+    if ((int)ws.prod.size() < n1 + nmu)
+        ws.prod.resize(n1 + nmu);
+    limbs_mul(ws.prod.data(), q1, n1, mu.z.data(), nmu, ws.scratch.data());
+
+    // r = (x - q * m) mod B^(k+1)
+    vector<limb>& r = ws.v;
+    r.assign(k + 1, 0);
+    copy(x.z.begin(), x.z.begin() + min(nx, k + 1), r.begin());
+    if (n3 > 0) {
+        vector<limb>& qm = ws.u;
+        if ((int)qm.size() < n3 + k)
+            qm.resize(n3 + k);
+        limbs_mul(qm.data(), ws.prod.data() + (k + 1), n3, m.z.data(), k, ws.scratch.data());
+        limbs_sub(r.data(), r.data(), k + 1, qm.data(), min(n3 + k, k + 1));
+    }
+    while (limbs_cmp(r.data(), k + 1, m.z.data(), k) >= 0)
+        limbs_sub(r.data(), r.data(), k + 1, m.z.data(), k);
+
+    dst.z.assign(r.begin(), r.end());
+    dst.sign = 1;
+    dst.trim();
+}
@@ -0,0 +1,42 @@
+// Barrett reduction for BigInt
+// Reference: P. Barrett, "Implementing the Rivest Shamir and Adleman Public Key Encryption Algorithm
+// on a Standard Digital Signal Processor" (1986)
+// Reference: A. Menezes et al., "Handbook of Applied Cryptography", Algorithm 14.42
+
+#ifndef Barrett_H
+#define Barrett_H
+
+#include "BigInt.h"
+
+// Reduction modulo a fixed m with two multiplications instead of a division
+// Works for any m > 0 (even ones too, unlike Montgomery); operands are ordinary BigInts
+class Barrett {
+private:
+    BigInt m;   // Modulus
+    int k;      // Limbs of m, B = 2^32
+    BigInt mu;  // floor(B^(2k) / m), the only division this context ever does
+
+public:
+    explicit Barrett(const BigInt& modulus);  // Built once per modulus
+
+    const BigInt& modulus() const { return m; }
+
+    // x mod m in [0, m); x below B^(2k) (e.g. a product of two reduced values) takes the fast path
+    BigInt reduce(const BigInt& x) const;
+
+    BigInt mul(const BigInt& a, const BigInt& b) const { return reduce(a * b); }
+    BigInt sqr(const BigInt& a) const { return reduce(a.square()); }
+
+    // In-place versions for hot loops: no allocation once ws is warmed up; dst may alias the operands
+    void reduce_into(BigInt& dst, const BigInt& x, BigIntWorkspace& ws) const;
+    void mul_into(BigInt& dst, const BigInt& a, const BigInt& b, BigIntWorkspace& ws) const {
+        ::mul_into(dst, a, b, ws);
+        reduce_into(dst, dst, ws);
+    }
+    void sqr_into(BigInt& dst, const BigInt& a, BigIntWorkspace& ws) const {
+        ::sqr_into(dst, a, ws);
+        reduce_into(dst, dst, ws);
+    }
+};
+
+#endif
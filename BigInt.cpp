@@ -2,27 +2,27 @@
 
 /*
 	Toán tử gán từ kiểu long long sang BigInt.
-	Cách làm: lấy dấu, chuyển số về dạng dương, rồi chia theo base để lưu vào vector z.
+	Cách làm: lấy dấu, chuyển số về dạng dương, rồi tách thành các limb 32 bit để lưu vào vector z.
 */
 
 
 BigInt& BigInt::operator=(long long v)
 {
 	sign = v < 0 ? -1 : 1;                  // Lưu dấu
-	v *= sign;                              // Chuyển về số dương để dễ xử lý
+	unsigned long long u = v < 0 ? 0ULL - (unsigned long long)v : (unsigned long long)v;  // Giá trị tuyệt đối (kể cả LLONG_MIN)
 	z.clear();
-	while (v > 0)
-    {
-        z.push_back((int)(v % base));
-        v /= base;
-    }
+	while (u > 0)
+	{
+		z.push_back((limb)u);
+		u >>= limb_bits;
+	}
 	return *this;
 }
 
 
 /*
 	Toán tử cộng gán +=
-	Nếu 2 số cùng dấu: cộng từng “khối” trong z, nhớ xử lý carry.
+	Nếu 2 số cùng dấu: cộng từng limb trong z, carry lấy từ nửa cao của phép cộng 64 bit.
 	Nếu khác dấu: quy về phép trừ.
 */
 
@@ -31,15 +31,17 @@ BigInt& BigInt::operator+=(const BigInt& other)
 	if (sign == other.sign)
 	{
 		// Hai số cùng dấu → cộng bình thường
-		for (int i = 0, carry = 0; i < other.z.size() || carry; ++i)
+		if (z.size() < other.z.size())
+			z.resize(other.z.size());
+		dlimb carry = 0;
+		for (size_t i = 0; i < z.size() && (i < other.z.size() || carry); ++i)
 		{
-			if (i == (int)z.size())
-				z.push_back(0);
-			z[i] += carry + (i < (int)other.z.size() ? other.z[i] : 0);
-			carry = z[i] >= base;
-			if (carry)
-				z[i] -= base;
+			dlimb cur = (dlimb)z[i] + (i < other.z.size() ? other.z[i] : 0) + carry;
+			z[i] = (limb)cur;
+			carry = cur >> limb_bits;
 		}
+		if (carry)
+			z.push_back((limb)carry);
 	}
 	else if (other != 0)
 	{
@@ -68,20 +70,20 @@ BigInt& BigInt::operator-=(const BigInt& other)
 	if (sign == other.sign)
 	{
 		// Hai số cùng dấu → kiểm tra độ lớn để trừ đúng hướng
-		if ((sign == 1 && *this >= other) || (sign == -1 && *this <= other))
+		if (cmp_abs(z, other.z) >= 0)
 		{
-			for (int i = 0, carry = 0; i < (int)other.z.size() || carry; ++i)
+			dlimb borrow = 0;
+			for (size_t i = 0; i < other.z.size() || borrow; ++i)
 			{
-				z[i] -= carry + (i < (int)other.z.size() ? other.z[i] : 0);
-				carry = z[i] < 0;
-				if (carry)
-					z[i] += base;
+				dlimb cur = (dlimb)z[i] - (i < other.z.size() ? other.z[i] : 0) - borrow;
+				z[i] = (limb)cur;
+				borrow = cur >> 63;  // Âm → bit cao nhất bật
 			}
 			trim();
 		}
 		else
 		{
-			// Nếu số bị trừ nhỏ hơn số trừ → đổi chiều và đổi dấu kết quả
+			// Nếu |số bị trừ| nhỏ hơn |số trừ| → đổi chiều và đổi dấu kết quả
 			*this = other - *this;
 			this->sign = -this->sign;
 		}
@@ -118,21 +120,22 @@ BigInt operator-(BigInt v)
 
 /*
 	Nhân BigInt với số nguyên int.
-	Cách làm: nhân từng block trong vector z, xử lý carry.
+	Cách làm: nhân từng limb trong vector z, xử lý carry.
 */
 
 BigInt& BigInt::operator*=(int v)
 {
 	if (v < 0)
 		sign = -sign, v = -v;
-	for (int i = 0, carry = 0; i < (int)z.size() || carry; ++i)
+	dlimb carry = 0;
+	for (size_t i = 0; i < z.size(); ++i)
 	{
-		if (i == (int)z.size())
-			z.push_back(0);
-			long long cur = 1LL * z[i] * v + carry;
-		carry = (int)(cur / base);
-		z[i] = (int)(cur % base);
+		dlimb cur = (dlimb)z[i] * (limb)v + carry;
+		z[i] = (limb)cur;
+		carry = cur >> limb_bits;
 	}
+	if (carry)
+		z.push_back((limb)carry);
 	trim();
 	return *this;
 }
@@ -152,22 +155,58 @@ BigInt BigInt::operator*(int v) const
 }
 
 /*
-	Nhân 2 BigInt.
-	Ngưỡng 150 block: nhỏ thì dùng nhân thường, lớn thì dùng FFT.
+	Nhân 2 BigInt, chọn thuật toán theo kích thước:
+	- Dưới karatsuba_threshold limb: nhân thường O(n²).
+	- Tới fft_threshold: Karatsuba / Toom-3 (limbs_mul), vùng của các số mật mã 512-8192 bit.
+	  Bộ nhớ tạm cấp một lần cho cả cây đệ quy.
+	- Lớn hơn: FFT; tổng từ ntt_threshold limb trở lên thì FFT số thực có thể làm tròn sai,
+	  dùng NTT (chính xác, không tách limb).
 */
 
 BigInt BigInt::operator*(const BigInt& v) const
 {
-	if (min(z.size(), v.z.size()) < 150)
+	int na = (int)z.size(), nb = (int)v.z.size();
+	if (min(na, nb) < karatsuba_threshold)
 		return mul_simple(v);
 	BigInt res;
 	res.sign = sign * v.sign;
-	res.z = multiply_bigint(convert_base(z, base_digits, fft_base_digits),
-		convert_base(v.z, base_digits, fft_base_digits), fft_base);
+	if (na + nb >= ntt_threshold)
+		res.z = multiply_ntt(vector<limb>(z.begin(), z.end()), vector<limb>(v.z.begin(), v.z.end()));
+	else if (min(na, nb) >= fft_threshold)
+		res.z = from_fft_digits(multiply_bigint(to_fft_digits(z), to_fft_digits(v.z), fft_base));
+	else
+	{
+		vector<limb> scratch(limbs_mul_scratch(na, nb));
+		res.z.resize(na + nb);
+		limbs_mul(res.z.data(), z.data(), na, v.z.data(), nb, scratch.data());
+	}
+	res.trim();
+	return res;
+}
 
-		// Chuyển kết quả về base chuẩn
+/*
+	Bình phương: cùng các ngưỡng như phép nhân nhưng mỗi tầng đều rẻ hơn.
+	- Nhân thường: mỗi tích chéo z[i] * z[j] (i < j) chỉ tính một lần rồi nhân đôi.
+	- Karatsuba / Toom-3: chỉ đánh giá đa thức một lần, các tích con đều là bình phương.
+	- FFT: ghép các chữ số thực thành nửa số điểm phức; NTT: một phép biến đổi xuôi cho mỗi số nguyên tố.
+*/
 
-	res.z = convert_base(res.z, fft_base_digits, base_digits);
+BigInt BigInt::square() const
+{
+	int n = (int)z.size();
+	BigInt res;
+	if (n == 0)
+		return res;
+	if (2 * n >= ntt_threshold)
+		res.z = square_ntt(vector<limb>(z.begin(), z.end()));
+	else if (n >= fft_threshold)
+		res.z = from_fft_digits(square_bigint(to_fft_digits(z), fft_base));
+	else
+	{
+		vector<limb> scratch(limbs_sqr_scratch(n));
+		res.z.resize(2 * n);
+		limbs_sqr(res.z.data(), z.data(), n, scratch.data());
+	}
 	res.trim();
 	return res;
 }
@@ -179,11 +218,12 @@ BigInt& BigInt::operator/=(int v)
 {
 	if (v < 0)
 		sign = -sign, v = -v;
-	for (int i = (int)z.size() - 1, rem = 0; i >= 0; --i)
+	dlimb rem = 0;
+	for (int i = (int)z.size() - 1; i >= 0; --i)
 	{
-		long long cur = z[i] + rem * 1LL * base;
-		z[i] = (int)(cur / v);
-		rem = (int)(cur % v);
+		dlimb cur = z[i] | (rem << limb_bits);
+		z[i] = (limb)(cur / (limb)v);
+		rem = cur % (limb)v;
 	}
 	trim();
 	return *this;
@@ -199,46 +239,189 @@ BigInt& BigInt::operator%=(const BigInt& v)
 	return *this;
 }
 
+/*
+	Nghịch đảo Newton: X ≈ 2^(nb + t) / b, nb = số bit của b, X có t + 1 bit.
+	- Chỉ t + 64 bit cao của b ảnh hưởng tới X, phần còn lại bỏ đi.
+	- Mỗi bước X = X + X * (2^(nb+t) - b * X) / 2^(nb+t) nhân đôi số bit đúng,
+	  nên tính X ở nửa độ chính xác rồi sửa một lần; tổng chi phí cỡ vài phép nhân t bit.
+	- t nhỏ: chia thẳng bằng thuật toán D.
+	Tham khảo: Brent & Zimmermann, "Modern Computer Arithmetic", 3.4.
+*/
+
+BigInt BigInt::reciprocal(const BigInt& b, int t)
+{
+	const int guard = limb_bits;
+	int nb = b.bitLength();
+	if (nb > t + 2 * guard)
+		return reciprocal(b >> (nb - t - 2 * guard), t);
+	if (t < newton_threshold * limb_bits)
+		return (BigInt(1) << (nb + t)) / b;
+
+	int h = t / 2 + guard;
+	BigInt x = reciprocal(b, h) << (t - h);
+	BigInt e = (BigInt(1) << (nb + t)) - b * x;
+	x += (x * e) >> (nb + t);
+	return x;
+}
+
+/*
+	Chia bằng nghịch đảo: q = a * X / 2^(nb+t) với t lớn hơn số bit của thương một limb,
+	nên q sai tối đa vài đơn vị; sửa lại bằng số dư.
+*/
+
+pair<BigInt, BigInt> BigInt::divmod_newton(const BigInt& a, const BigInt& b)
+{
+	int nb = b.bitLength();
+	int t = a.bitLength() - nb + limb_bits;
+	BigInt q = (a * reciprocal(b, t)) >> (nb + t);
+	BigInt r = a - q * b;
+	while (r < 0)
+	{
+		q -= 1;
+		r += b;
+	}
+	while (r >= b)
+	{
+		q += 1;
+		r -= b;
+	}
+	return { q, r };
+}
+
 /*
 	Hàm chia lấy cả thương và dư.
-	Thuật toán: chuẩn hóa (normalize) rồi chia long division.
+	Thuật toán D của Knuth (TAOCP vol. 2, 4.3.1): chuẩn hóa bằng dịch bit để limb cao nhất
+	của số chia có bit 31 bật, ước lượng mỗi chữ số thương từ 2 limb cao, sai tối đa 2.
+	Số chia và thương đều từ newton_threshold limb trở lên: chia bằng nghịch đảo Newton,
+	chi phí ngang vài phép nhân nhanh thay vì O(n²).
 */
 
+/*
+	Lõi của thuật toán D trên mảng limb, dùng chung cho divmod và mod_into.
+	u, v là bộ nhớ tạm của người gọi (số bị chia và số chia đã chuẩn hóa), q = nullptr nếu chỉ cần dư.
+	Điều kiện: na >= nb >= 1, b[nb - 1] != 0.
+*/
+
+static void knuth_divmod(const limb* a, int na, const limb* b, int n, limb* q, LimbVector& r, vector<limb>& u, vector<limb>& v)
+{
+	int m = na - n;
+	if (n == 1)
+	{
+		// Số chia 1 limb → chia ngắn
+		dlimb rem = 0;
+		for (int i = na - 1; i >= 0; --i)
+		{
+			dlimb cur = a[i] | (rem << limb_bits);
+			if (q)
+				q[i] = (limb)(cur / b[0]);
+			rem = cur % b[0];
+		}
+		r.assign(1, (limb)rem);
+		return;
+	}
+
+	// Chuẩn hóa: dịch trái s bit
+	int s = 0;
+	while (!(b[n - 1] << s & 0x80000000u))
+		++s;
+	u.resize(na + 1);
+	v.resize(n);
+	for (int i = n - 1; i > 0; --i)
+		v[i] = s ? (b[i] << s) | (b[i - 1] >> (limb_bits - s)) : b[i];
+	v[0] = b[0] << s;
+	u[na] = s ? a[na - 1] >> (limb_bits - s) : 0;
+	for (int i = na - 1; i > 0; --i)
+		u[i] = s ? (a[i] << s) | (a[i - 1] >> (limb_bits - s)) : a[i];
+	u[0] = a[0] << s;
+
+	// Chia từ limb lớn nhất xuống nhỏ nhất
+	const dlimb B = (dlimb)1 << limb_bits;
+	for (int j = m; j >= 0; --j)
+	{
+		// Ước lượng chữ số thương
+		dlimb num = ((dlimb)u[j + n] << limb_bits) | u[j + n - 1];
+		dlimb qhat = num / v[n - 1], rhat = num % v[n - 1];
+		while (qhat >= B || qhat * v[n - 2] > ((rhat << limb_bits) | u[j + n - 2]))
+		{
+			--qhat;
+			rhat += v[n - 1];
+			if (rhat >= B)
+				break;
+		}
+
+		// u[j..j+n] -= qhat * v
+		dlimb carry = 0, borrow = 0;
+		for (int i = 0; i < n; ++i)
+		{
+			dlimb p = qhat * v[i] + carry;
+			carry = p >> limb_bits;
+			dlimb t = (dlimb)u[i + j] - (limb)p - borrow;
+			u[i + j] = (limb)t;
+			borrow = t >> 63;
+		}
+		dlimb t = (dlimb)u[j + n] - carry - borrow;
+		u[j + n] = (limb)t;
+
+		// Ước lượng dư 1 → cộng lại v
+		if (t >> 63)
+		{
+			--qhat;
+			carry = 0;
+			for (int i = 0; i < n; ++i)
+			{
+				dlimb cur = (dlimb)u[i + j] + v[i] + carry;
+				u[i + j] = (limb)cur;
+				carry = cur >> limb_bits;
+			}
+			u[j + n] += (limb)carry;
+		}
+		if (q)
+			q[j] = (limb)qhat;
+	}
+
+	// Số dư = u[0..n-1] dịch phải s bit
+	r.resize(n);
+	for (int i = 0; i < n; ++i)
+		r[i] = s ? (u[i] >> s) | (u[i + 1] << (limb_bits - s)) : u[i];
+}
+
 pair<BigInt, BigInt> divmod(const BigInt& a1, const BigInt& b1)
 {
-	int norm = base / (b1.z.back() + 1);
-	BigInt a = a1.abs() * norm;
-	BigInt b = b1.abs() * norm;
+	assert(!b1.isZero());
 	BigInt q, r;
-	q.z.resize(a.z.size());
-
-	// Chia từ block lớn nhất xuống nhỏ nhất
+	if (BigInt::cmp_abs(a1.z, b1.z) < 0)
+	{
+		r = a1;
+		return { q, r };
+	}
 
-	for (int i = (int)a.z.size() - 1; i >= 0; i--)
+	const LimbVector& a = a1.z;
+	const LimbVector& b = b1.z;
+	int n = (int)b.size(), m = (int)a.size() - n;
+	if (n >= newton_threshold && m >= newton_threshold)
 	{
-		r *= base;
-		r += a.z[i];
-		int s1 = b.z.size() < r.z.size() ? r.z[b.z.size()] : 0;
-		int s2 = b.z.size() - 1 < r.z.size() ? r.z[b.z.size() - 1] : 0;
-
-		// Ước lượng chữ số chia 
-
-		int d = (int)(((long long)s1 * base + s2) / b.z.back());
-		r -= b * d;
-		while (r < 0)
-			r += b, --d;
-		q.z[i] = d;
+		pair<BigInt, BigInt> res = BigInt::divmod_newton(a1.abs(), b1.abs());
+		res.first.sign = a1.sign * b1.sign;
+		res.second.sign = a1.sign;
+		res.first.trim();
+		res.second.trim();
+		return res;
 	}
 
+	vector<limb> u, v;
+	q.z.assign(m + 1, 0);
+	knuth_divmod(a.data(), (int)a.size(), b.data(), n, q.z.data(), r.z, u, v);
+
 	q.sign = a1.sign * b1.sign;
 	r.sign = a1.sign;
 	q.trim();
 	r.trim();
-	return { q, r / norm };
+	return { q, r };
 }
 
 /*
 	Nhân đơn giản O(n²). Dùng khi số không quá lớn.
+	z[i] * v[j] + res + carry luôn vừa 64 bit: (2^32 - 1)^2 + 2 * (2^32 - 1) = 2^64 - 1.
 */
 
 
@@ -247,18 +430,154 @@ BigInt BigInt::mul_simple(const BigInt& v) const
 	BigInt res;
 	res.sign = sign * v.sign;
 	res.z.resize(z.size() + v.z.size());
-	for (int i = 0; i < (int)z.size(); ++i)
+	for (size_t i = 0; i < z.size(); ++i)
 		if (z[i])
-			for (int j = 0, carry = 0; j < (int)v.z.size() || carry; ++j)
+		{
+			dlimb carry = 0;
+			for (size_t j = 0; j < v.z.size(); ++j)
 			{
-				long long cur = res.z[i + j] + (long long)z[i] * (j < v.z.size() ? v.z[j] : 0) + carry;
-				carry = (int)(cur / base);
-				res.z[i + j] = (int)(cur % base);
+				dlimb cur = res.z[i + j] + (dlimb)z[i] * v.z[j] + carry;
+				res.z[i + j] = (limb)cur;
+				carry = cur >> limb_bits;
 			}
+			res.z[i + v.z.size()] = (limb)carry;
+		}
 	res.trim();
 	return res;
 }
 
+/*
+	Các phép toán tại chỗ: ghi kết quả vào dst, mọi bộ nhớ tạm lấy từ workspace của người gọi.
+	Vector chỉ tăng kích thước, không bao giờ co lại, nên sau vài lần gọi đầu tiên
+	(khởi động) vòng lặp lũy thừa không còn cấp phát bộ nhớ nào.
+	Khi dst trùng với toán hạng, tích được tính vào ws.prod rồi đổi chỗ (swap) với dst.z.
+*/
+
+template <class Buffer>
+static void grow(Buffer& buf, size_t n)
+{
+	if (buf.size() < n)
+		buf.resize(n);
+}
+
+void mul_into(BigInt& dst, const BigInt& a, const BigInt& b, BigIntWorkspace& ws)
+{
+	int na = (int)a.z.size(), nb = (int)b.z.size();
+	if (na == 0 || nb == 0)
+	{
+		dst = 0;
+		return;
+	}
+	if (min(na, nb) >= fft_threshold || na + nb >= ntt_threshold)
+	{
+		dst = a * b;
+		return;
+	}
+	int sign = a.sign * b.sign;
+	bool alias = &dst == &a || &dst == &b;
+	LimbVector& out = alias ? ws.prod : dst.z;
+	out.resize(na + nb);
+	grow(ws.scratch, limbs_mul_scratch(na, nb));
+	limbs_mul(out.data(), a.z.data(), na, b.z.data(), nb, ws.scratch.data());
+	if (alias)
+		dst.z.swap(ws.prod);
+	dst.sign = sign;
+	dst.trim();
+}
+
+void sqr_into(BigInt& dst, const BigInt& a, BigIntWorkspace& ws)
+{
+	int n = (int)a.z.size();
+	if (n >= fft_threshold)
+	{
+		dst = a.square();
+		return;
+	}
+	bool alias = &dst == &a;
+	LimbVector& out = alias ? ws.prod : dst.z;
+	out.resize(2 * n);
+	grow(ws.scratch, limbs_sqr_scratch(n));
+	limbs_sqr(out.data(), a.z.data(), n, ws.scratch.data());
+	if (alias)
+		dst.z.swap(ws.prod);
+	dst.sign = 1;
+	dst.trim();
+}
+
+/*
+	Dấu của kết quả giống toán tử %: theo dấu của số bị chia.
+*/
+
+void mod_into(BigInt& dst, const BigInt& a, const BigInt& m, BigIntWorkspace& ws)
+{
+	assert(!m.isZero());
+	int sign = a.sign;
+	int na = (int)a.z.size(), n = (int)m.z.size();
+	if (BigInt::cmp_abs(a.z, m.z) < 0)
+	{
+		if (&dst != &a)
+			dst.z.assign(a.z.begin(), a.z.end());
+	}
+	else if (n >= newton_threshold && na - n >= newton_threshold)
+	{
+		dst = a % m;
+		return;
+	}
+	else
+		knuth_divmod(a.z.data(), na, m.z.data(), n, nullptr, dst.z, ws.u, ws.v);
+	dst.sign = sign;
+	dst.trim();
+}
+
+/*
+	dst += a * b: tích nằm trong ws.prod, cộng (hoặc trừ, nếu khác dấu) trực tiếp vào dst.z.
+*/
+
+void addmul(BigInt& dst, const BigInt& a, const BigInt& b, BigIntWorkspace& ws)
+{
+	int na = (int)a.z.size(), nb = (int)b.z.size();
+	if (na == 0 || nb == 0)
+		return;
+	if (min(na, nb) >= fft_threshold || na + nb >= ntt_threshold)
+	{
+		dst += a * b;
+		return;
+	}
+	int psign = a.sign * b.sign;
+	int np = na + nb;
+	grow(ws.prod, np);
+	grow(ws.scratch, limbs_mul_scratch(na, nb));
+	limbs_mul(ws.prod.data(), a.z.data(), na, b.z.data(), nb, ws.scratch.data());
+	while (np > 0 && ws.prod[np - 1] == 0)
+		--np;
+
+	LimbVector& z = dst.z;
+	int nz = (int)z.size();
+	if (nz == 0 || dst.sign == psign)
+	{
+		// Cùng dấu → cộng độ lớn
+		if (nz < np)
+		{
+			z.resize(np);
+			nz = np;
+		}
+		limb carry = limbs_add(z.data(), z.data(), nz, ws.prod.data(), np);
+		if (carry)
+			z.push_back(carry);
+		dst.sign = psign;
+	}
+	else if (limbs_cmp(z.data(), nz, ws.prod.data(), np) >= 0)
+		limbs_sub(z.data(), z.data(), nz, ws.prod.data(), np);
+	else
+	{
+		// |dst| < |a * b| → kết quả mang dấu của tích
+		z.resize(np);
+		limbs_sub(z.data(), ws.prod.data(), np, z.data(), nz);
+		dst.sign = psign;
+	}
+	dst.trim();
+}
+
 /*
 	Toán tử chia / và % dùng divmod()
 */
@@ -288,26 +607,124 @@ int BigInt::operator%(int v) const
 {
 	if (v < 0)
 		v = -v;
-	int m = 0;
+	dlimb m = 0;
 	for (int i = (int)z.size() - 1; i >= 0; --i)
-		m = (int)((z[i] + m * 1LL*base) % v);
-	return m * sign;
+		m = (z[i] | (m << limb_bits)) % (limb)v;
+	return (int)m * sign;
+}
+
+/*
+	Các phép toán trên bit (trên giá trị tuyệt đối, giữ nguyên dấu).
+	Dịch = dịch nguyên limb (shift / 32) rồi dịch phần bit lẻ (shift % 32), O(số limb).
+*/
+
+BigInt& BigInt::operator<<=(int shift)
+{
+	if (shift < 0)
+		return *this >>= -shift;
+	if (z.empty() || shift == 0)
+		return *this;
+	int limbs = shift / limb_bits, bits = shift % limb_bits;
+	if (bits)
+	{
+		z.push_back(0);
+		for (int i = (int)z.size() - 1; i > 0; --i)
+			z[i] = (z[i] << bits) | (z[i - 1] >> (limb_bits - bits));
+		z[0] <<= bits;
+	}
+	z.insert(z.begin(), limbs, 0);
+	trim();
+	return *this;
+}
+
+BigInt& BigInt::operator>>=(int shift)
+{
+	if (shift < 0)
+		return *this <<= -shift;
+	int limbs = shift / limb_bits, bits = shift % limb_bits;
+	if (limbs >= (int)z.size())
+	{
+		z.clear();
+		trim();
+		return *this;
+	}
+	z.erase(z.begin(), z.begin() + limbs);
+	if (bits)
+	{
+		for (size_t i = 0; i + 1 < z.size(); ++i)
+			z[i] = (z[i] >> bits) | (z[i + 1] << (limb_bits - bits));
+		z.back() >>= bits;
+	}
+	trim();
+	return *this;
+}
+
+BigInt BigInt::operator<<(int shift) const
+{
+	return BigInt(*this) <<= shift;
+}
+
+BigInt BigInt::operator>>(int shift) const
+{
+	return BigInt(*this) >>= shift;
+}
+
+bool BigInt::testBit(int i) const
+{
+	int k = i / limb_bits;
+	return i >= 0 && k < (int)z.size() && (z[k] >> (i % limb_bits) & 1);
+}
+
+void BigInt::setBit(int i)
+{
+	int k = i / limb_bits;
+	if (k >= (int)z.size())
+		z.resize(k + 1);
+	z[k] |= (limb)1 << (i % limb_bits);
+}
+
+int BigInt::bitLength() const
+{
+	if (z.empty())
+		return 0;
+	int len = ((int)z.size() - 1) * limb_bits;
+	for (limb top = z.back(); top; top >>= 1)
+		++len;
+	return len;
+}
+
+int BigInt::lowestSetBit() const
+{
+	for (size_t k = 0; k < z.size(); ++k)
+		if (z[k])
+		{
+			int i = (int)k * limb_bits;
+			for (limb w = z[k]; !(w & 1); w >>= 1)
+				++i;
+			return i;
+		}
+	return -1;
 }
 
 /*
 	Các toán tử so sánh
 */
 
+int BigInt::cmp_abs(const LimbVector& a, const LimbVector& b)
+{
+	if (a.size() != b.size())
+		return a.size() < b.size() ? -1 : 1;
+	for (int i = (int)a.size() - 1; i >= 0; i--)
+		if (a[i] != b[i])
+			return a[i] < b[i] ? -1 : 1;
+	return 0;
+}
+
 bool BigInt::operator<(const BigInt& v) const
 {
 	if (sign != v.sign)
 		return sign < v.sign;
-	if (z.size() != v.z.size())
-		return z.size() * sign < v.z.size() * v.sign;
-	for (int i = (int)z.size() - 1; i >= 0; i--)
-		if (z[i] != v.z[i])
-			return z[i] * sign < v.z[i] * sign;
-	return false;
+	return cmp_abs(z, v.z) * sign < 0;
 }
 
 bool BigInt::operator>(const BigInt& v) const { return v < *this; }
@@ -342,14 +759,15 @@ long long BigInt::longValue() const
 	Chuyển BigInt về long long (cẩn thận tràn!)
     */
 
-	long long res = 0;
+	unsigned long long res = 0;
 	for (int i = (int)z.size() - 1; i >= 0; i--)
-		res = res * base + z[i];
-	return res * sign;
+		res = (res << limb_bits) | z[i];
+	return (long long)res * sign;
 }
 
 /*
 	Đọc BigInt từ string (nhập input).
+	Đọc từng khối decimal_digits chữ số từ trái sang phải: z = z * 10^9 + khối.
 */
 
 
@@ -364,12 +782,24 @@ void BigInt::read(const string& s)
 			sign = -sign;
 		++pos;
 	}
-	for (int i = (int)s.size() - 1; i >= pos; i -= base_digits)
+	int first = ((int)s.size() - pos) % decimal_digits;
+	for (int i = pos; i < (int)s.size(); )
 	{
-		int x = 0;
-		for (int j = max(pos, i - base_digits + 1); j <= i; j++)
-			x = x * 10 + s[j] - '0';
-		z.push_back(x);
+		int len = (i == pos && first) ? first : decimal_digits;
+		limb x = 0, mul = 1;
+		for (int j = i; j < i + len; j++)
+			x = x * 10 + (s[j] - '0'), mul *= 10;
+		i += len;
+
+		dlimb carry = x;
+		for (size_t k = 0; k < z.size(); k++)
+		{
+			dlimb cur = (dlimb)z[k] * mul + carry;
+			z[k] = (limb)cur;
+			carry = cur >> limb_bits;
+		}
+		if (carry)
+			z.push_back((limb)carry);
 	}
 	trim();
 }
@@ -387,48 +817,60 @@ istream& operator>>(istream& stream, BigInt& v)
 	return stream;
 }
 
+/*
+	Xuất: chia liên tiếp cho 10^9 để lấy các khối thập phân (chỉ đổi hệ ở biên nhập/xuất).
+*/
+
 ostream& operator<<(ostream& stream, const BigInt& v)
 {
 	if (v.sign == -1)
 		stream << '-';
-	// In block cao nhất (không có số 0 đệm)
-	stream << (v.z.empty() ? 0 : v.z.back());
+	LimbVector a = v.z;
+	vector<limb> chunks;
+	while (!a.empty())
+	{
+		dlimb rem = 0;
+		for (int i = (int)a.size() - 1; i >= 0; --i)
+		{
+			dlimb cur = a[i] | (rem << limb_bits);
+			a[i] = (limb)(cur / decimal_base);
+			rem = cur % decimal_base;
+		}
+		chunks.push_back((limb)rem);
+		while (!a.empty() && a.back() == 0)
+			a.pop_back();
+	}
+
+	// In khối cao nhất (không có số 0 đệm)
+	stream << (chunks.empty() ? 0 : chunks.back());
 
-	// In các block còn lại có đệm 0 cho đủ base_digits
-	for (int i = (int)v.z.size() - 2; i >= 0; --i)
-		stream << setw(base_digits) << setfill('0') << v.z[i];
+	// In các khối còn lại có đệm 0 cho đủ decimal_digits
+	for (int i = (int)chunks.size() - 2; i >= 0; --i)
+		stream << setw(decimal_digits) << setfill('0') << chunks[i];
 	return stream;
 }
 
 /*
-	Hàm chuyển đổi base (đổi số lượng chữ số mỗi block).
+	Tách / ghép limb cho FFT: mỗi limb 32 bit thành 2 chữ số fft_base = 2^16.
 	Dùng khi muốn nhân FFT.
 */
 
 
-vector<int> BigInt::convert_base(const vector<int>& a, int old_digits, int new_digits)
+vector<int> BigInt::to_fft_digits(const LimbVector& a)
 {
-	vector<long long> p(max(old_digits, new_digits) + 1);
-	p[0] = 1;
-	for (int i = 1; i < p.size(); i++)
-		p[i] = p[i - 1] * 10;
-	vector<int> res;
-	long long cur = 0;
-	int cur_digits = 0;
-	for (int v : a)
+	vector<int> res(2 * a.size());
+	for (size_t i = 0; i < a.size(); i++)
 	{
-		cur += v * p[cur_digits];
-		cur_digits += old_digits;
-		
-		while (cur_digits >= new_digits)
-		{
-			res.push_back(int(cur % p[new_digits]));
-			cur /= p[new_digits];
-			cur_digits -= new_digits;
-		}
+		res[2 * i] = (int)(a[i] & (fft_base - 1));
+		res[2 * i + 1] = (int)(a[i] >> fft_base_bits);
 	}
-	res.push_back((int)cur);
-	while (!res.empty() && res.back() == 0)
-		res.pop_back();
 	return res;
-}
\ No newline at end of file
+}
+
+vector<limb> BigInt::from_fft_digits(const vector<int>& a)
+{
+	vector<limb> res((a.size() + 1) / 2);
+	for (size_t i = 0; i < a.size(); i++)
+		res[i / 2] |= (limb)a[i] << (i % 2 * fft_base_bits);
+	return res;
+}
@@ -5,23 +5,47 @@
 #define BigInt_H
 
 #include "fft.h"
+#include "ntt.h"
+#include "limbs.h"
+#include "limb_vector.h"
 #include <iomanip>
 
 constexpr int digits(int base) noexcept {
     return base <= 1 ? 0 : 1 + digits(base / 10);
 }
-constexpr int base = 1000'000'000;
-constexpr int base_digits = digits(base);
 
-constexpr int fft_base = 10'000;  // fft_base^2 * n / fft_base_digits <= 10^15 for double
-constexpr int fft_base_digits = digits(fft_base);
+constexpr int decimal_base = 1000'000'000;  // Decimal chunks, used only by read() and operator<<
+constexpr int decimal_digits = digits(decimal_base);
+
+constexpr int fft_base_bits = 16;  // Each limb is split into two FFT digits
+constexpr int fft_base = 1 << fft_base_bits;  // fft_base^2 * n <= 2^52 for double
+
+constexpr int fft_threshold = 1024;   // Limbs in the smaller operand; below this Karatsuba / Toom-3 win
+constexpr int ntt_threshold = 16384;  // Limbs in both operands; beyond this the FFT rounding margin is gone, use the exact NTT
+constexpr int newton_threshold = 2048;  // Limbs in both divisor and quotient; from here division goes through a Newton reciprocal
 
 using namespace std;
 
+// Reusable buffers for the in-place operations (mul_into, sqr_into, mod_into, addmul)
+// Buffers only grow, so once warmed up to the working size no call allocates again
+// (below fft_threshold; the FFT / NTT / Newton paths still allocate their own transforms)
+// One workspace per thread: it is not safe to share between concurrent calls
+struct BigIntWorkspace {
+    vector<limb> scratch;  // Karatsuba / Toom-3 recursion
+    LimbVector prod;       // Products that cannot be written straight into the destination
+    vector<limb> u, v;     // Normalized dividend / divisor of algorithm D, Barrett temporaries
+};
+
 class BigInt {
 private:
-    vector<int> z;  // Digits
-    int sign;       // sign == 1 for positive, -1 for negative
+    LimbVector z;    // Limbs, least significant first, inline up to 4096 bits
+    int sign;        // sign == 1 for positive, -1 for negative
+
+    static int cmp_abs(const LimbVector& a, const LimbVector& b);  // Compare magnitudes
+    static vector<int> to_fft_digits(const LimbVector& a);
+    static vector<limb> from_fft_digits(const vector<int>& a);
+    static BigInt reciprocal(const BigInt& b, int t);  // About 2^(bitLength(b) + t) / b, off by at most 2
+    static pair<BigInt, BigInt> divmod_newton(const BigInt& a, const BigInt& b);  // a, b > 0
 
 public:
     BigInt(long long v = 0) { *this = v; }  // Constructor from long long
@@ -40,16 +64,33 @@ public:
     BigInt mul_simple(const BigInt& v) const;
     friend pair<BigInt, BigInt> divmod(const BigInt&, const BigInt&);
 
+    // In-place variants: the result goes into dst, which may alias any operand
+    friend void mul_into(BigInt& dst, const BigInt& a, const BigInt& b, BigIntWorkspace& ws);  // dst = a * b
+    friend void sqr_into(BigInt& dst, const BigInt& a, BigIntWorkspace& ws);                   // dst = a * a
+    friend void mod_into(BigInt& dst, const BigInt& a, const BigInt& m, BigIntWorkspace& ws);  // dst = a % m
+    friend void addmul(BigInt& dst, const BigInt& a, const BigInt& b, BigIntWorkspace& ws);    // dst += a * b
+
     friend BigInt operator+(BigInt, const BigInt&);
     friend BigInt operator-(BigInt, const BigInt&);
     friend BigInt operator-(BigInt v);
     BigInt operator*(int) const;
     BigInt operator*(const BigInt&) const;
+    BigInt square() const;  // *this * *this, about 2/3 of the cost of a general product
     BigInt operator/(const BigInt&) const;
     BigInt operator/(int) const;
     BigInt operator%(const BigInt&) const;
     int operator%(int) const;
 
+    // Bit-level access on the magnitude (sign is kept as is)
+    BigInt& operator<<=(int shift);
+    BigInt& operator>>=(int shift);
+    BigInt operator<<(int shift) const;
+    BigInt operator>>(int shift) const;
+    bool testBit(int i) const;     // O(1)
+    void setBit(int i);            // O(1) unless the number grows
+    int bitLength() const;         // O(1), 0 for zero
+    int lowestSetBit() const;      // O(limbs), -1 for zero
+
     bool operator<(const BigInt& v) const;
     bool operator>(const BigInt& v) const;
     bool operator<=(const BigInt& v) const;
@@ -64,10 +105,48 @@ public:
 
     void read(const string& s);
 
+    // Uniform random number below 2^bits, written straight into the limbs from any generator of
+    // 64-bit words (ChaChaRng, mt19937_64); top_bit_set forces bit bits - 1, so the bit length is
+    // exact, and odd forces bit 0
+    template <class Rng>
+    static BigInt random_bits(Rng& rng, int bits, bool top_bit_set = false, bool odd = false);
+
     friend istream& operator>>(istream& stream, BigInt& v);
     friend ostream& operator<<(ostream& stream, const BigInt& v);
 
-    static vector<int> convert_base(const vector<int>& a, int old_digits, int new_digits);
+    friend class Montgomery;  // Work directly on the limbs
+    friend class Barrett;
+    template <int Bits>
+    friend class FixedInt;
 };
 
+template <class Rng>
+BigInt BigInt::random_bits(Rng& rng, int bits, bool top_bit_set, bool odd) {
+    BigInt res;
+    if (bits <= 0)
+        return res;
+    int n = (bits + limb_bits - 1) / limb_bits;
+    res.z.resize(n);
+    for (int i = 0; i < n; i += 2) {  // Two limbs per draw
+        uint64_t w = rng();
+        res.z[i] = (limb)w;
+        if (i + 1 < n)
+            res.z[i + 1] = (limb)(w >> limb_bits);
+    }
+    int top = bits - (n - 1) * limb_bits;  // Bits used in the top limb, 1 to limb_bits
+    if (top < limb_bits)
+        res.z[n - 1] &= ((limb)1 << top) - 1;
+    if (top_bit_set)
+        res.z[n - 1] |= (limb)1 << (top - 1);
+    if (odd)
+        res.z[0] |= 1;
+    res.trim();
+    return res;
+}
+
+void mul_into(BigInt& dst, const BigInt& a, const BigInt& b, BigIntWorkspace& ws);
+void sqr_into(BigInt& dst, const BigInt& a, BigIntWorkspace& ws);
+void mod_into(BigInt& dst, const BigInt& a, const BigInt& m, BigIntWorkspace& ws);
+void addmul(BigInt& dst, const BigInt& a, const BigInt& b, BigIntWorkspace& ws);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,104 @@
+#include "DiffieHellman.h"
+#include "chacha20.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+struct DHKeyGenerator::Pool {
+    std::vector<std::thread> workers;
+    std::mutex batch;                    // Held by the generate() call that owns the workers
+
+    std::mutex mtx;                      // Guards everything below except next
+    std::condition_variable wake;        // New batch or shutdown
+    std::condition_variable finished;    // Last worker left the batch
+    std::vector<DHKeyPair>* keys = nullptr;
+    uint64_t generation = 0;             // Bumped once per batch so workers never rejoin an old one
+    size_t active = 0;                   // Workers that have not yet left the current batch
+    bool stopping = false;
+
+    std::atomic<size_t> next{0};         // Next key to claim in the current batch
+};
+
+DHKeyGenerator::DHKeyGenerator(const BigInt& p, const BigInt& g, int threads)
+    : table(g, p), private_keys(BigInt(2), p - 2), pool(new Pool) {
+    assert(p >= 5);
+    if (threads <= 0)
+        threads = std::max(1, (int)std::thread::hardware_concurrency());
+    for (int t = 1; t < threads; t++)
+        pool->workers.emplace_back(&DHKeyGenerator::run_worker, this);
+}
+
+DHKeyGenerator::~DHKeyGenerator() {
+    {
+        std::lock_guard<std::mutex> lk(pool->mtx);
+        pool->stopping = true;
+    }
+    pool->wake.notify_all();
+    for (std::thread& t : pool->workers)
+        t.join();
+}
+
+// Workers claim keys one at a time: each is a full exponentiation, so the counter is never contended
+void DHKeyGenerator::compute_public_keys(std::vector<DHKeyPair>& keys) const {
+    for (size_t i = pool->next++; i < keys.size(); i = pool->next++)
+        keys[i].public_key = table.pow(keys[i].private_key);
+}
+
+void DHKeyGenerator::run_worker() const {
+    uint64_t seen = 0;
+    for (;;) {
+        std::vector<DHKeyPair>* keys;
+        {
+            std::unique_lock<std::mutex> lk(pool->mtx);
+            pool->wake.wait(lk, [&] { return pool->stopping || pool->generation != seen; });
+            if (pool->stopping)
+                return;
+            seen = pool->generation;
+            keys = pool->keys;
+        }
+        compute_public_keys(*keys);
+        std::lock_guard<std::mutex> lk(pool->mtx);
+        if (--pool->active == 0)
+            pool->finished.notify_one();
+    }
+}
+
+std::vector<DHKeyPair> DHKeyGenerator::generate(size_t count) const {
+    std::vector<DHKeyPair> keys(count);
+    ChaChaRng& rng = ChaChaRng::thread_instance();
+    for (DHKeyPair& key : keys)
+        key.private_key = private_keys(rng);
+
+    // Tiny batches are not worth waking anyone
+    if (count < 2 || pool->workers.empty()) {
+        for (DHKeyPair& key : keys)
+            key.public_key = table.pow(key.private_key);
+        return keys;
+    }
+
+    std::lock_guard<std::mutex> owner(pool->batch);
+    {
+        std::lock_guard<std::mutex> lk(pool->mtx);
+        pool->keys = &keys;
+        pool->next = 0;
+        pool->active = pool->workers.size();
+        pool->generation++;
+    }
+    pool->wake.notify_all();
+    compute_public_keys(keys);
+
+    // Every worker has to leave the batch before keys (and next) can be reused
+    std::unique_lock<std::mutex> lk(pool->mtx);
+    pool->finished.wait(lk, [&] { return pool->active == 0; });
+    pool->keys = nullptr;
+    return keys;
+}
+
+std::vector<DHKeyPair> generate_dh_keypairs(const BigInt& p, const BigInt& g, size_t count, int threads) {
+    return DHKeyGenerator(p, g, threads).generate(count);
+}
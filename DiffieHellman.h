@@ -0,0 +1,51 @@
+// Batch Diffie-Hellman key generation for one group (p, g)
+// Pre-generating a pool of ephemeral keys shares everything that depends only on the group: the
+// fixed-base table of powers of g (with its Montgomery context) and the private-key distribution
+// Private keys come from one generator stream on the calling thread; the public keys g^x mod p,
+// which are almost all of the cost, are spread over worker threads that the generator starts once
+// and keeps for its whole lifetime
+
+#ifndef DiffieHellman_H
+#define DiffieHellman_H
+
+#include "BigInt.h"
+#include "FixedBase.h"
+#include "UniformBigInt.h"
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+struct DHKeyPair {
+    BigInt private_key;  // Uniform in [2, p - 2]
+    BigInt public_key;   // g^private_key mod p
+};
+
+// Built once per group and reused for every batch; generate() is const and may be called from
+// several threads, but batches take turns on the shared workers
+class DHKeyGenerator {
+public:
+    // p odd and >= 5; threads = 0 uses one per hardware thread (the caller of generate() counts as one)
+    DHKeyGenerator(const BigInt& p, const BigInt& g, int threads = 0);
+    ~DHKeyGenerator();  // Stops and joins the workers
+
+    std::vector<DHKeyPair> generate(size_t count) const;
+
+    const BigInt& modulus() const { return table.modulus(); }
+    const BigInt& generator() const { return table.base(); }
+
+private:
+    FixedBaseExp table;
+    UniformBigIntDistribution private_keys;
+
+    struct Pool;  // Persistent workers and the batch they are on (DiffieHellman.cpp)
+    std::unique_ptr<Pool> pool;
+
+    void run_worker() const;
+    void compute_public_keys(std::vector<DHKeyPair>& keys) const;
+};
+
+// One-off batch: count key pairs for (p, g)
+std::vector<DHKeyPair> generate_dh_keypairs(const BigInt& p, const BigInt& g, size_t count, int threads = 0);
+
+#endif
@@ -0,0 +1,118 @@
+#include "FixedBase.h"
+#include "FixedInt.h"
+#include "ModExp.h"
+
+struct FixedBaseExp::Impl {
+    virtual ~Impl() {}
+    virtual BigInt pow(const BigInt& e) const = 0;
+    virtual BigInt pow_base(const BigInt& base, const BigInt& e) const = 0;
+};
+
+namespace {
+
+// table[i] = g^(2^(w*i)); top = g^(2^(w*digits)) covers exponents longer than the table
+template <class Mont>
+class PowerTable : public FixedBaseExp::Impl {
+    using Value = typename Mont::Value;
+
+    Mont mont;
+    int w, digits;
+    vector<Value> table;
+    Value top;
+
+public:
+    PowerTable(const Mont& context, const BigInt& g, int max_bits, int w)
+        : mont(context), w(w), digits((max_bits + w - 1) / w), table(max(digits, 1)) {
+        table[0] = mont.to_mont(g);
+        for (int i = 1; i <= digits; i++) {
+            Value x = table[i - 1];
+            for (int k = 0; k < w; k++)
+                mont.sqr(x, x);
+            if (i < digits)
+                table[i] = x;
+            else
+                top = x;
+        }
+        if (digits == 0)
+            top = table[0];
+    }
+
+    BigInt pow(const BigInt& e) const override {
+        // Base-2^w digits of the part of e the table covers
+        vector<int> dig(digits, 0);
+        for (int i = 0; i < digits; i++)
+            for (int k = w - 1; k >= 0; k--)
+                dig[i] = (dig[i] << 1) | (int)e.testBit(i * w + k);
+
+        // Yao: B collects the table entries whose digit is >= j, A multiplies in B once per j
+        Value a = mont.one(), b = mont.one();
+        bool has_a = false, has_b = false;
+        for (int j = (1 << w) - 1; j >= 1; j--) {
+            for (int i = 0; i < digits; i++) {
+                if (dig[i] != j)
+                    continue;
+                if (has_b)
+                    mont.mul(b, b, table[i]);
+                else
+                    b = table[i], has_b = true;
+            }
+            if (has_b) {
+                if (has_a)
+                    mont.mul(a, a, b);
+                else
+                    a = b, has_a = true;
+            }
+        }
+
+        // Bits beyond the table: top^(e >> (w * digits)) by square-and-multiply
+        int high = e.bitLength() - 1;
+        if (high >= w * digits) {
+            Value h = mont.one();
+            for (int i = high; i >= w * digits; i--) {
+                mont.sqr(h, h);
+                if (e.testBit(i))
+                    mont.mul(h, h, top);
+            }
+            mont.mul(a, a, h);
+        }
+        return mont.from_mont(a);
+    }
+
+    BigInt pow_base(const BigInt& base, const BigInt& e) const override {
+        return modular_exponentiation(base, e, mont);
+    }
+};
+
+// max_bits / w + 2^w multiplications per pow
+int best_window(int max_bits) {
+    int best = 1;
+    for (int w = 2; w <= 12; w++)
+        if ((max_bits + w - 1) / w + (1 << w) < (max_bits + best - 1) / best + (1 << best))
+            best = w;
+    return best;
+}
+
+}  // namespace
+
+FixedBaseExp::FixedBaseExp(const BigInt& g, const BigInt& p, int max_bits, int w) : g(g), p(p) {
+    assert(Montgomery::supports(p));
+    if (max_bits <= 0)
+        max_bits = p.bitLength();
+    this->w = w > 0 ? w : best_window(max_bits);
+    impl = with_montgomery(p, [&](const auto& mont) -> std::unique_ptr<const Impl> {
+        using Mont = typename std::decay<decltype(mont)>::type;
+        return std::unique_ptr<const Impl>(new PowerTable<Mont>(mont, g, max_bits, this->w));
+    });
+}
+
+FixedBaseExp::~FixedBaseExp() {}
+
+BigInt FixedBaseExp::pow(const BigInt& e) const {
+    assert(e >= 0);
+    return impl->pow(e);
+}
+
+BigInt FixedBaseExp::pow_base(const BigInt& base, const BigInt& e) const {
+    assert(e >= 0);
+    return impl->pow_base(base, e);
+}
@@ -0,0 +1,38 @@
+// Fixed-base modular exponentiation g^e mod p for a base and modulus known in advance
+// Reference: E. F. Brickell, D. M. Gordon, K. S. McCurley, D. B. Wilson, "Fast Exponentiation
+// with Precomputation" (1992), with Yao's method for the product
+// Reference: A. Menezes et al., "Handbook of Applied Cryptography", Algorithm 14.109
+
+#ifndef FixedBase_H
+#define FixedBase_H
+
+#include "BigInt.h"
+
+#include <memory>
+
+// Built once per (g, p): stores g^(2^(w*i)) in Montgomery form for every w-bit digit position i
+// of an exponent up to max_bits long. Each pow then needs about max_bits / w + 2^w multiplications
+// and no squaring at all (a sliding window needs max_bits squarings on top of its multiplications)
+// w is picked to minimize that count unless given; p must be odd and > 1
+class FixedBaseExp {
+public:
+    FixedBaseExp(const BigInt& g, const BigInt& p, int max_bits = 0, int w = 0);  // max_bits = 0: p's size
+    ~FixedBaseExp();
+
+    BigInt pow(const BigInt& e) const;  // g^e mod p for e >= 0; longer exponents than max_bits still work, slower
+    // base^e mod p for any other base, on the same Montgomery context (no table, sliding window)
+    BigInt pow_base(const BigInt& base, const BigInt& e) const;
+
+    const BigInt& base() const { return g; }
+    const BigInt& modulus() const { return p; }
+    int window() const { return w; }
+
+    struct Impl;
+
+private:
+    BigInt g, p;
+    int w;
+    std::unique_ptr<const Impl> impl;  // Table on the fixed-width or the dynamic Montgomery context
+};
+
+#endif
@@ -0,0 +1,351 @@
+// Fixed-width integers for key sizes known at compile time
+// FixedInt<Bits> keeps its limbs in a std::array, so every loop bound is a constant the compiler
+// can unroll: no resizing, no trimming, no size branches
+// FixedMontgomery<Bits> is the Montgomery context of Montgomery.h on top of it, one instantiation
+// per DH group size (e.g. 512, 2048, 4096)
+// Where the compiler has a 128-bit integer the words are 64 bits wide: a quarter of the word
+// products of BigInt's 32-bit limbs for the same width
+
+#ifndef FixedInt_H
+#define FixedInt_H
+
+#include "BigInt.h"
+#include "Montgomery.h"
+
+#include <array>
+
+#if defined(__SIZEOF_INT128__)
+using fword = uint64_t;             // Word of a FixedInt
+using dfword = unsigned __int128;   // Double-width intermediate for word products
+#else
+using fword = uint32_t;
+using dfword = uint64_t;
+#endif
+constexpr int fword_bits = sizeof(fword) * 8;
+constexpr int limbs_per_fword = fword_bits / limb_bits;
+
+template <int Bits>
+class FixedInt {
+public:
+    static constexpr int N = (Bits + fword_bits - 1) / fword_bits;  // Words
+    using Wide = std::array<fword, 2 * N>;                           // Full product of two values
+
+private:
+    std::array<fword, N> d;  // Words, least significant first
+
+public:
+    FixedInt() : d{} {}
+    explicit FixedInt(const BigInt& v) : d{} {  // Magnitude of v, must fit in N words
+        assert((int)v.z.size() <= N * limbs_per_fword);
+        for (size_t i = 0; i < v.z.size(); i++)
+            d[i / limbs_per_fword] |= (fword)v.z[i] << (i % limbs_per_fword * limb_bits);
+    }
+
+    BigInt to_bigint() const {
+        BigInt res;
+        res.z.resize(N * limbs_per_fword);
+        for (int i = 0; i < N * limbs_per_fword; i++)
+            res.z[i] = (limb)(d[i / limbs_per_fword] >> (i % limbs_per_fword * limb_bits));
+        res.trim();
+        return res;
+    }
+
+    fword& operator[](int i) { return d[i]; }
+    const fword& operator[](int i) const { return d[i]; }
+    const fword* data() const { return d.data(); }
+
+    bool isZero() const {
+        fword acc = 0;
+        for (int i = 0; i < N; i++)
+            acc |= d[i];
+        return acc == 0;
+    }
+    bool testBit(int i) const { return d[i / fword_bits] >> (i % fword_bits) & 1; }
+
+    friend bool operator==(const FixedInt& a, const FixedInt& b) { return a.d == b.d; }
+    friend bool operator!=(const FixedInt& a, const FixedInt& b) { return a.d != b.d; }
+    friend bool operator<(const FixedInt& a, const FixedInt& b) { return cmp(a, b) < 0; }
+
+    static int cmp(const FixedInt& a, const FixedInt& b) {
+        for (int i = N - 1; i >= 0; i--)
+            if (a.d[i] != b.d[i])
+                return a.d[i] < b.d[i] ? -1 : 1;
+        return 0;
+    }
+
+    // r = a + b mod 2^(Bits), returns the carry out; r may alias a or b
+    static fword add(FixedInt& r, const FixedInt& a, const FixedInt& b) {
+        dfword carry = 0;
+        for (int i = 0; i < N; i++) {
+            carry += (dfword)a.d[i] + b.d[i];
+            r.d[i] = (fword)carry;
+            carry >>= fword_bits;
+        }
+        return (fword)carry;
+    }
+
+    // r = a - b mod 2^(Bits), returns the borrow out; r may alias a or b
+    static fword sub(FixedInt& r, const FixedInt& a, const FixedInt& b) {
+        dfword borrow = 0;
+        for (int i = 0; i < N; i++) {
+            dfword cur = (dfword)a.d[i] - b.d[i] - borrow;
+            r.d[i] = (fword)cur;
+            borrow = cur >> (2 * fword_bits - 1);
+        }
+        return (fword)borrow;
+    }
+
+    // r = a * b, schoolbook with constant bounds
+    static void mul(Wide& r, const FixedInt& a, const FixedInt& b) {
+        r.fill(0);
+        for (int i = 0; i < N; i++) {
+            dfword carry = 0;
+            for (int j = 0; j < N; j++) {
+                dfword cur = r[i + j] + (dfword)a.d[i] * b.d[j] + carry;
+                r[i + j] = (fword)cur;
+                carry = cur >> fword_bits;
+            }
+            r[i + N] = (fword)carry;
+        }
+    }
+
+    // r = a^2, each cross product once (as limbs_sqr_basecase)
+    static void sqr(Wide& r, const FixedInt& a) {
+        r.fill(0);
+        for (int i = 0; i < N; i++) {
+            dfword carry = 0;
+            for (int j = i + 1; j < N; j++) {
+                dfword cur = r[i + j] + (dfword)a.d[i] * a.d[j] + carry;
+                r[i + j] = (fword)cur;
+                carry = cur >> fword_bits;
+            }
+            r[i + N] = (fword)carry;
+        }
+        for (int i = 2 * N - 1; i > 0; i--)
+            r[i] = (r[i] << 1) | (r[i - 1] >> (fword_bits - 1));
+        r[0] <<= 1;
+        dfword carry = 0;
+        for (int i = 0; i < N; i++) {
+            dfword sq = (dfword)a.d[i] * a.d[i];
+            carry += (dfword)r[2 * i] + (fword)sq;
+            r[2 * i] = (fword)carry;
+            carry >>= fword_bits;
+            carry += (dfword)r[2 * i + 1] + (sq >> fword_bits);
+            r[2 * i + 1] = (fword)carry;
+            carry >>= fword_bits;
+        }
+    }
+
+    FixedInt& operator+=(const FixedInt& v) { add(*this, *this, v); return *this; }
+    FixedInt& operator-=(const FixedInt& v) { sub(*this, *this, v); return *this; }
+};
+
+// Same algorithms as Montgomery (CIOS multiply, square then separate REDC), with R = 2^(fword_bits * N) fixed
+template <int Bits>
+class FixedMontgomery {
+public:
+    using Value = FixedInt<Bits>;
+    static constexpr int N = Value::N;
+
+private:
+    BigInt m;      // Modulus p
+    Value mod;     // Limbs of p
+    fword m_inv;   // -p^-1 mod 2^fword_bits
+    Value r_mod;   // R mod p (Montgomery form of 1)
+    Value r2_mod;  // R^2 mod p
+    int norm_shift;  // Leading zero bits of the top word of p
+    fword mod_top;   // Top word of p shifted left by norm_shift, for quotient estimates
+
+    // out = t mod p for t < 2p, t given as N words plus a top word
+    void final_subtract(Value& out, const fword* t, fword top) const {
+        bool ge = top != 0;
+        if (!ge) {
+            ge = true;
+            for (int j = N - 1; j >= 0; j--)
+                if (t[j] != mod[j]) {
+                    ge = t[j] > mod[j];
+                    break;
+                }
+        }
+        dfword borrow = 0;
+        for (int j = 0; j < N; j++) {
+            dfword cur = (dfword)t[j] - (ge ? mod[j] : 0) - borrow;
+            borrow = cur >> (2 * fword_bits - 1);
+            out[j] = (fword)cur;
+        }
+    }
+
+public:
+    // Odd modulus > 1 that needs exactly N words, so R is no larger than for the dynamic context
+    static bool supports(const BigInt& modulus) {
+        return Montgomery::supports(modulus) && (modulus.bitLength() + fword_bits - 1) / fword_bits == N;
+    }
+
+    explicit FixedMontgomery(const BigInt& modulus) : m(modulus), mod(modulus) {
+        assert(supports(modulus));
+        fword inv = mod[0];  // Correct to 3 bits for any odd p
+        for (int bits = 3; bits < fword_bits; bits *= 2)
+            inv *= 2 - mod[0] * inv;
+        m_inv = 0 - inv;
+        r_mod = Value((BigInt(1) << (N * fword_bits)) % m);
+        r2_mod = Value((BigInt(1) << (2 * N * fword_bits)) % m);
+        norm_shift = 0;
+        while (!(mod[N - 1] << norm_shift >> (fword_bits - 1)))
+            norm_shift++;
+        mod_top = mod[N - 1] << norm_shift;
+        if (norm_shift && N > 1)
+            mod_top |= mod[N - 2] >> (fword_bits - norm_shift);
+    }
+
+    const BigInt& modulus() const { return m; }
+    const Value& one() const { return r_mod; }
+
+    Value to_mont(const BigInt& x) const {
+        BigInt v = x;
+        if (v < 0 || v >= m) {
+            v %= m;
+            if (v < 0)
+                v += m;
+        }
+        Value a(v);
+        mul(a, a, r2_mod);
+        return a;
+    }
+
+    BigInt from_mont(const Value& x) const {
+        Value unit;
+        unit[0] = 1;
+        mul(unit, x, unit);
+        return unit.to_bigint();
+    }
+
+    // out = a * b * R^-1 mod p; out may alias a or b
+    void mul(Value& out, const Value& a, const Value& b) const {
+        std::array<fword, N + 2> t{};
+        for (int i = 0; i < N; i++) {
+            dfword ai = a[i], carry = 0, cur;
+            for (int j = 0; j < N; j++) {
+                cur = t[j] + ai * b[j] + carry;
+                carry = cur >> fword_bits;
+                t[j] = (fword)cur;
+            }
+            cur = t[N] + carry;
+            t[N] = (fword)cur;
+            t[N + 1] = (fword)(cur >> fword_bits);
+
+            dfword u = (fword)(t[0] * m_inv);
+            carry = (t[0] + u * mod[0]) >> fword_bits;
+            for (int j = 1; j < N; j++) {
+                cur = t[j] + u * mod[j] + carry;
+                carry = cur >> fword_bits;
+                t[j - 1] = (fword)cur;
+            }
+            cur = t[N] + carry;
+            t[N - 1] = (fword)cur;
+            t[N] = t[N + 1] + (fword)(cur >> fword_bits);
+        }
+        final_subtract(out, t.data(), t[N]);
+    }
+
+    // out = a^2 * R^-1 mod p; out may alias a
+    void sqr(Value& out, const Value& a) const {
+        typename Value::Wide t;
+        Value::sqr(t, a);
+        dfword hi = 0;
+        for (int i = 0; i < N; i++) {
+            dfword u = (fword)(t[i] * m_inv), carry = 0, cur;
+            for (int j = 0; j < N; j++) {
+                cur = t[i + j] + u * mod[j] + carry;
+                carry = cur >> fword_bits;
+                t[i + j] = (fword)cur;
+            }
+            cur = t[i + N] + carry + hi;
+            t[i + N] = (fword)cur;
+            hi = cur >> fword_bits;
+        }
+        final_subtract(out, t.data() + N, (fword)hi);
+    }
+
+    // out = a * s mod p for a single-limb s (as Montgomery::mul_small); out may alias a
+    void mul_small(Value& out, const Value& a, limb s) const {
+        std::array<fword, N + 1> t;
+        dfword carry = 0;
+        for (int j = 0; j < N; j++) {
+            carry += (dfword)a[j] * s;
+            t[j] = (fword)carry;
+            carry >>= fword_bits;
+        }
+        t[N] = (fword)carry;
+        if (s <= 2) {
+            final_subtract(out, t.data(), t[N]);
+            return;
+        }
+
+        int sh = norm_shift;
+        fword below = N > 1 ? t[N - 2] : 0;
+        fword hi = sh ? t[N] << sh | t[N - 1] >> (fword_bits - sh) : t[N];
+        fword lo = sh ? t[N - 1] << sh | below >> (fword_bits - sh) : t[N - 1];
+        dfword q = (((dfword)hi << fword_bits) | lo) / mod_top;
+        if (q > s)
+            q = s;
+
+        dfword borrow = 0;
+        carry = 0;
+        for (int j = 0; j < N; j++) {
+            carry += q * mod[j];
+            dfword cur = (dfword)t[j] - (fword)carry - borrow;
+            t[j] = (fword)cur;
+            borrow = cur >> (2 * fword_bits - 1);
+            carry >>= fword_bits;
+        }
+        t[N] = (fword)(t[N] - carry - borrow);
+        while (t[N] != 0) {
+            carry = 0;
+            for (int j = 0; j < N; j++) {
+                carry += (dfword)t[j] + mod[j];
+                t[j] = (fword)carry;
+                carry >>= fword_bits;
+            }
+            t[N] += (fword)carry;
+        }
+        for (int j = 0; j < N; j++)
+            out[j] = t[j];
+    }
+
+    // Residue arithmetic as in Montgomery; out may alias a or b
+    void add(Value& out, const Value& a, const Value& b) const {
+        Value t;
+        fword top = Value::add(t, a, b);
+        final_subtract(out, t.data(), top);
+    }
+    void sub(Value& out, const Value& a, const Value& b) const {
+        if (Value::sub(out, a, b))
+            Value::add(out, out, mod);
+    }
+    void half(Value& out, const Value& a) const {
+        Value t = a;
+        fword top = a[0] & 1 ? Value::add(t, t, mod) : 0;
+        for (int j = 0; j < N - 1; j++)
+            out[j] = t[j] >> 1 | t[j + 1] << (fword_bits - 1);
+        out[N - 1] = t[N - 1] >> 1 | top << (fword_bits - 1);
+    }
+};
+
+// Calls f with the Montgomery context of an odd modulus: the fixed-width one when its word count
+// matches a DH group size (64 to 4096 bits), the dynamic one otherwise
+template <class F>
+auto with_montgomery(const BigInt& mod, F&& f) -> decltype(f(std::declval<const Montgomery&>())) {
+    switch ((mod.bitLength() + fword_bits - 1) / fword_bits) {
+        case 64 / fword_bits:   return f(FixedMontgomery<64>(mod));
+        case 128 / fword_bits:  return f(FixedMontgomery<128>(mod));
+        case 256 / fword_bits:  return f(FixedMontgomery<256>(mod));
+        case 512 / fword_bits:  return f(FixedMontgomery<512>(mod));
+        case 1024 / fword_bits: return f(FixedMontgomery<1024>(mod));
+        case 2048 / fword_bits: return f(FixedMontgomery<2048>(mod));
+        case 3072 / fword_bits: return f(FixedMontgomery<3072>(mod));
+        case 4096 / fword_bits: return f(FixedMontgomery<4096>(mod));
+        default:                return f(Montgomery(mod));
+    }
+}
+
+#endif
@@ -0,0 +1,124 @@
+#include "HandshakeEngine.h"
+#include "FixedBase.h"
+#include "Montgomery.h"
+#include "UniformBigInt.h"
+#include "chacha20.h"
+
+#include <algorithm>
+#include <cassert>
+
+// The Montgomery context of p lives in g_pow and serves both exponentiations
+struct HandshakeEngine::Group {
+    BigInt max_peer;                          // p - 2: peer keys 0, 1 and p - 1 give away the secret
+    FixedBaseExp g_pow;                       // Public keys from the powers of g, shared secrets by pow_base
+    UniformBigIntDistribution private_keys;   // [2, p - 2]
+
+    Group(const BigInt& p, const BigInt& g) : max_peer(p - 2), g_pow(g, p), private_keys(BigInt(2), p - 2) {}
+};
+
+namespace {
+
+uint64_t elapsed_ns(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to) {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(to - from).count();
+}
+
+}  // namespace
+
+HandshakeEngine::HandshakeEngine(const BigInt& p, const BigInt& g, int workers, size_t queue_capacity)
+    : queue(queue_capacity) {
+    assert(p >= 5 && Montgomery::supports(p));
+    group.reset(new Group(p, g));
+    if (workers <= 0)
+        workers = std::max(1, (int)std::thread::hardware_concurrency());
+    for (int t = 0; t < workers; t++)
+        pool.emplace_back(&HandshakeEngine::run_worker, this);
+}
+
+HandshakeEngine::~HandshakeEngine() {
+    {
+        std::lock_guard<std::mutex> lock(idle_mtx);
+        stopping.store(true);
+    }
+    idle.notify_all();
+    for (std::thread& t : pool)
+        t.join();
+}
+
+std::future<HandshakeResult> HandshakeEngine::submit(const BigInt& peer_public) {
+    auto promise = std::make_shared<std::promise<HandshakeResult>>();
+    std::future<HandshakeResult> result = promise->get_future();
+    submit(peer_public, [promise](HandshakeResult r) { promise->set_value(std::move(r)); });
+    return result;
+}
+
+void HandshakeEngine::submit(const BigInt& peer_public, Callback done) {
+    Request req{peer_public, std::move(done), Clock::now()};
+    while (!queue.try_push(req))
+        std::this_thread::yield();
+    // Pairs with the fence in run_worker: either this sees the sleeper or the sleeper sees the push
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleeping.load() > 0) {
+        std::lock_guard<std::mutex> lock(idle_mtx);  // A worker between its check and its wait sees the push
+        idle.notify_one();
+    }
+}
+
+HandshakeStats HandshakeEngine::stats() const {
+    HandshakeStats s;
+    s.completed = counters.completed.load();
+    s.rejected = counters.rejected.load();
+    s.queue_depth = queue.size();
+    if (s.completed > 0) {
+        double n = (double)s.completed * 1000;  // ns -> us
+        s.queue_wait_us = counters.queue_wait.load() / n;
+        s.keygen_us = counters.keygen.load() / n;
+        s.public_key_us = counters.public_key.load() / n;
+        s.shared_secret_us = counters.shared_secret.load() / n;
+    }
+    return s;
+}
+
+// Workers spin on the queue while there is work and sleep on the condition variable when it is empty
+void HandshakeEngine::run_worker() {
+    Request req;
+    while (true) {
+        if (queue.try_pop(req)) {
+            process(req);
+            req = Request();  // Drop the peer key and the callback before sleeping
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(idle_mtx);
+        if (stopping.load() && queue.size() == 0)
+            return;
+        ++sleeping;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        idle.wait(lock, [&] { return stopping.load() || queue.size() > 0; });
+        --sleeping;
+    }
+}
+
+void HandshakeEngine::process(Request& req) {
+    Clock::time_point start = Clock::now();
+    HandshakeResult result;
+    const Group& grp = *group;
+    if (req.peer < 2 || req.peer > grp.max_peer) {
+        ++counters.rejected;
+        req.done(std::move(result));
+        return;
+    }
+
+    result.private_key = grp.private_keys(ChaChaRng::thread_instance());
+    Clock::time_point t1 = Clock::now();
+    result.public_key = grp.g_pow.pow(result.private_key);
+    Clock::time_point t2 = Clock::now();
+    result.shared_secret = grp.g_pow.pow_base(req.peer, result.private_key);
+    Clock::time_point t3 = Clock::now();
+    result.ok = true;
+
+    counters.queue_wait += elapsed_ns(req.submitted, start);
+    counters.keygen += elapsed_ns(start, t1);
+    counters.public_key += elapsed_ns(t1, t2);
+    counters.shared_secret += elapsed_ns(t2, t3);
+    ++counters.completed;
+    req.done(std::move(result));
+}
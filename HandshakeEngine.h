@@ -0,0 +1,96 @@
+// Asynchronous Diffie-Hellman handshakes for embedding in a server
+// One engine per group (p, g): requests carrying the peer's public key go into a lock-free queue,
+// a fixed pool of workers runs the three steps of main() on them (private key, public key,
+// shared secret) and completes a future or calls a callback
+// Everything that depends only on the group is built once and shared by the workers: the powers
+// of g, the Montgomery context of p and the private-key distribution; each worker has its own
+// random generator and thread-local exponentiation scratch (window tables, kept across requests)
+// There is no per-worker arena: keys up to 4096 bits are inline BigInts, and the heap buffers that
+// remain (the scratch tables, and the MontValue vectors of groups without a fixed-width context)
+// come from the global allocator
+
+#ifndef HandshakeEngine_H
+#define HandshakeEngine_H
+
+#include "BigInt.h"
+#include "mpmc_queue.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct HandshakeResult {
+    bool ok = false;       // false: the peer's key is outside [2, p - 2] and nothing was computed
+    BigInt private_key;    // Our ephemeral key x
+    BigInt public_key;     // g^x mod p, to send to the peer
+    BigInt shared_secret;  // peer^x mod p
+};
+
+// Means in microseconds over every completed handshake (rejected ones are only counted)
+struct HandshakeStats {
+    uint64_t completed = 0;
+    uint64_t rejected = 0;      // Peer keys out of range
+    size_t queue_depth = 0;     // Requests waiting right now
+    double queue_wait_us = 0;   // Submit to start of processing
+    double keygen_us = 0;       // Private key draw
+    double public_key_us = 0;   // g^x
+    double shared_secret_us = 0;  // peer^x
+};
+
+class HandshakeEngine {
+public:
+    using Callback = std::function<void(HandshakeResult)>;
+
+    // p odd and >= 5; workers = 0 uses one per hardware thread
+    HandshakeEngine(const BigInt& p, const BigInt& g, int workers = 0, size_t queue_capacity = 1024);
+    // Finishes every request already submitted, then stops the workers
+    ~HandshakeEngine();
+    HandshakeEngine(const HandshakeEngine&) = delete;
+    HandshakeEngine& operator=(const HandshakeEngine&) = delete;
+
+    // Both wait (yielding) while the queue is full; any thread may submit
+    std::future<HandshakeResult> submit(const BigInt& peer_public);
+    void submit(const BigInt& peer_public, Callback done);  // done runs on a worker thread
+
+    size_t queue_depth() const { return queue.size(); }
+    HandshakeStats stats() const;
+    int workers() const { return (int)pool.size(); }
+
+    struct Group;  // Group state: powers of g on the Montgomery context of p, key distribution
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Request {
+        BigInt peer;
+        Callback done;
+        Clock::time_point submitted;
+    };
+
+    // Sums in nanoseconds, read by stats()
+    struct Counters {
+        std::atomic<uint64_t> completed{0}, rejected{0};
+        std::atomic<uint64_t> queue_wait{0}, keygen{0}, public_key{0}, shared_secret{0};
+    };
+
+    std::unique_ptr<const Group> group;
+    MpmcQueue<Request> queue;
+    std::vector<std::thread> pool;
+    std::atomic<bool> stopping{false};
+    std::atomic<int> sleeping{0};  // Workers waiting on idle; submit only signals when there are any
+    std::mutex idle_mtx;
+    std::condition_variable idle;
+    Counters counters;
+
+    void run_worker();
+    void process(Request& req);
+};
+
+#endif
@@ -0,0 +1,104 @@
+#include "ModExp.h"
+#include "Barrett.h"
+
+#include <cassert>
+
+int window_size(int bits, WindowMode mode) {
+    int best = 1;
+    double best_cost = 0;
+    for (int w = 1; w <= 8; w++) {
+        double cost;
+        if (mode == WindowMode::sliding)
+            cost = (w > 1 ? (1 << (w - 1)) : 0) + bits / (w + 1.0);
+        else if (mode == WindowMode::fixed)
+            cost = (1 << w) - 2 + (double)bits / w;
+        else
+            cost = (1 << w) - 2 + (double)bits / w * (1 - 1.0 / (1 << w));
+        if (w == 1 || cost < best_cost) {
+            best = w;
+            best_cost = cost;
+        }
+    }
+    return best;
+}
+
+bool is_small_base(const BigInt& base, const BigInt& mod) {
+    return base >= 0 && base < mod && base.bitLength() <= limb_bits;
+}
+
+BigInt modular_exponentiation(BigInt base, const BigInt& exponent, const Montgomery& mont,
+                              WindowMode mode) {
+    if (exponent.isZero()) return BigInt(1);
+    if (mode != WindowMode::fixed && is_small_base(base, mont.modulus()))
+        return small_base_exponentiation((limb)base.longValue(), exponent, mont);
+
+    MontValue b = mont.to_mont(base);
+    if (b == MontValue(mont.size(), 0)) return BigInt(0);
+
+    MontValue result = mont.one();
+    window_exponentiation(exponent, b, result,
+        [&](MontValue& x) { mont.sqr(x, x); },
+        [&](MontValue& x, const MontValue& y) { mont.mul(x, x, y); }, mode);
+
+    return mont.from_mont(result);
+}
+
+BigInt modular_exponentiation(BigInt base, BigInt exponent,const BigInt& mod,
+                              WindowMode mode) {
+    // Special cases
+    if (mod == 1) return BigInt(0);
+    if (exponent.isZero()) return BigInt(1) % mod;
+
+    // Odd moduli (every prime we work with) go through Montgomery form
+    if (Montgomery::supports(mod)) {
+        // DH group sizes get the fixed-width kernels
+        return with_montgomery(mod, [&](const auto& mont) { return modular_exponentiation(base, exponent, mont, mode); });
+    }
+
+    // Even moduli: Barrett reduction, still no division inside the loop
+    Barrett bar(mod);
+    base = bar.reduce(base);
+    if (base.isZero()) return BigInt(0);
+
+    BigIntWorkspace ws;  // Reused by every step, the loop below does not allocate
+    BigInt result = 1;
+
+    // Compute result using window exponentiation
+    window_exponentiation(exponent, base, result,
+        [&](BigInt& x) { bar.sqr_into(x, x, ws); },
+        [&](BigInt& x, const BigInt& y) { bar.mul_into(x, x, y, ws); }, mode);
+
+    return result;
+}
+
+BigInt multi_exponentiation(const std::vector<BigInt>& bases, const std::vector<BigInt>& exponents, const BigInt& mod) {
+    assert(bases.size() == exponents.size());
+    for (const BigInt& e : exponents)
+        assert(e >= 0);
+    if (mod == 1) return BigInt(0);
+
+    if (Montgomery::supports(mod)) {
+        return with_montgomery(mod, [&](const auto& mont) {
+            using Value = typename std::decay<decltype(mont)>::type::Value;
+            std::vector<Value> b;
+            for (const BigInt& x : bases)
+                b.push_back(mont.to_mont(x));
+            Value result = mont.one();
+            interleaved_exponentiation(exponents, b, result,
+                [&](Value& x) { mont.sqr(x, x); },
+                [&](Value& x, const Value& y) { mont.mul(x, x, y); });
+            return mont.from_mont(result);
+        });
+    }
+
+    Barrett bar(mod);
+    std::vector<BigInt> b;
+    for (const BigInt& x : bases)
+        b.push_back(bar.reduce(x));
+    BigIntWorkspace ws;
+    BigInt result = 1;
+    interleaved_exponentiation(exponents, b, result,
+        [&](BigInt& x) { bar.sqr_into(x, x, ws); },
+        [&](BigInt& x, const BigInt& y) { bar.mul_into(x, x, y, ws); });
+    return result;
+}
@@ -0,0 +1,250 @@
+// Modular exponentiation: sliding / fixed / m-ary windows, single-limb bases and simultaneous
+// products, on the Montgomery contexts for odd moduli and on Barrett reduction for even ones
+// Shared by the command-line program and the library parts that need b^e mod p for a
+// variable base (e.g. the shared-secret step of a handshake)
+
+#ifndef ModExp_H
+#define ModExp_H
+
+#include "BigInt.h"
+#include "Montgomery.h"
+#include "FixedInt.h"
+
+#include <algorithm>
+#include <vector>
+
+// How the exponent is cut into windows
+enum class WindowMode {
+    sliding,  // Windows start and end on set bits, table of odd powers only: fewest multiplies
+    fixed,    // Constant structure: every w-bit digit costs w squarings and one multiply, zero
+              // digits included, so the sequence of operations depends only on the exponent length
+    m_ary     // Fixed w-bit digits, zero digits skip their multiply
+};
+
+// Window width minimizing table building plus main-loop multiplies for an exponent of this length
+// Sliding: 2^(w-1) table steps, about bits / (w + 1) multiplies
+// Fixed digits: 2^w - 2 table steps, bits / w multiplies (m-ary saves the zero digits, 1 in 2^w)
+int window_size(int bits, WindowMode mode);
+
+// Window exponentiation from the highest bit, shared by the Montgomery and the Barrett path
+// Walks the exponent bits directly with testBit, no arithmetic on the exponent
+// result holds the identity on entry and base^exponent on return; sqr(x) sets x = x^2, mul(x, y) sets x = x * y
+// W = 0 picks the width from the exponent length; the table lives in thread-local storage that is
+// reused across calls, so repeated exponentiations keep its memory
+template <class T, class Sqr, class Mul>
+void window_exponentiation(const BigInt& exponent, const T& base, T& result, Sqr sqr, Mul mul,
+                           WindowMode mode = WindowMode::sliding, int W = 0) {
+    int bits = exponent.bitLength();
+    if (W <= 0)
+        W = window_size(bits, mode);
+    thread_local std::vector<T> pre;
+    if ((int)pre.size() < (1 << W))
+        pre.resize(1 << W);
+
+    if (mode == WindowMode::sliding) {
+        // pre[u] = base^u for odd u < 2^W
+        pre[1] = base;
+        if (W > 1) {
+            T base2 = base;
+            sqr(base2);
+            for (int e = 3; e < (1 << W); e += 2) {
+                pre[e] = pre[e - 2];
+                mul(pre[e], base2);
+            }
+        }
+
+        int i = bits - 1;   // index bit cao nhất
+        while (i >= 0) {
+            if (!exponent.testBit(i)) {
+                sqr(result);
+                --i;
+            }
+            else {
+                int l = std::max(0, i - W + 1);
+                int j = l;
+
+                while (j < i && !exponent.testBit(j)) {
+                    ++j;
+                }
+                int length = i - j + 1;
+
+                int u = 0;
+                for (int k = i; k >= j; --k) {
+                    u = (u << 1) | (int)exponent.testBit(k);
+                }
+
+                for (int k = 0; k < length; ++k) {
+                    sqr(result);
+                }
+
+                mul(result, pre[u]);
+
+                i = j - 1;
+            }
+        }
+        return;
+    }
+
+    // pre[u] = base^u for every u < 2^W, pre[0] the identity
+    pre[0] = result;
+    pre[1] = base;
+    for (int e = 2; e < (1 << W); e++) {
+        pre[e] = pre[e - 1];
+        mul(pre[e], base);
+    }
+
+    // Digits from the top; the leading one is padded with zero bits
+    bool first = true;
+    for (int i = (bits + W - 1) / W * W - W; i >= 0; i -= W) {
+        int u = 0;
+        for (int k = i + W - 1; k >= i; --k) {
+            u = (u << 1) | (int)exponent.testBit(k);
+        }
+
+        if (mode == WindowMode::m_ary && first) {
+            result = pre[u];  // The top digit is never zero
+        }
+        else {
+            for (int k = 0; k < W; ++k) {
+                sqr(result);
+            }
+            if (mode == WindowMode::fixed || u != 0) {
+                mul(result, pre[u]);
+            }
+        }
+        first = false;
+    }
+}
+
+// Single-limb bases (g = 2 in DH, Miller-Rabin witnesses): plain left-to-right binary, where the
+// multiply step is mont.mul_small, linear in the modulus size, instead of a table multiply
+// Leaves only the squarings at full cost and needs no precomputation
+template <class Mont>
+BigInt small_base_exponentiation(limb s, const BigInt& exponent, const Mont& mont) {
+    typename Mont::Value result = mont.one();
+    for (int i = exponent.bitLength() - 1; i >= 0; i--) {
+        mont.sqr(result, result);
+        if (exponent.testBit(i))
+            mont.mul_small(result, result, s);
+    }
+    return mont.from_mont(result);
+}
+
+// True when base is reduced and fits one limb, the case small_base_exponentiation covers
+bool is_small_base(const BigInt& base, const BigInt& mod);
+
+// Modular exponentiation in Montgomery form
+// The context is built once per modulus and can be reused across calls (e.g. Miller-Rabin rounds)
+// Every square and multiply is a fused multiply-reduce, no division inside the loop
+// Small bases take the single-limb path except in fixed mode, which keeps its constant structure
+BigInt modular_exponentiation(BigInt base, const BigInt& exponent, const Montgomery& mont,
+                              WindowMode mode = WindowMode::sliding);
+
+// Same exponentiation on a compile-time width: the limb loops of every step have constant bounds
+template <int Bits>
+BigInt modular_exponentiation(BigInt base, const BigInt& exponent, const FixedMontgomery<Bits>& mont,
+                              WindowMode mode = WindowMode::sliding) {
+    using Value = typename FixedMontgomery<Bits>::Value;
+    if (exponent.isZero()) return BigInt(1);
+    if (mode != WindowMode::fixed && is_small_base(base, mont.modulus()))
+        return small_base_exponentiation((limb)base.longValue(), exponent, mont);
+
+    Value b = mont.to_mont(base);
+    if (b.isZero()) return BigInt(0);
+
+    Value result = mont.one();
+    window_exponentiation(exponent, b, result,
+        [&](Value& x) { mont.sqr(x, x); },
+        [&](Value& x, const Value& y) { mont.mul(x, x, y); }, mode);
+
+    return mont.from_mont(result);
+}
+
+// AModular exponentiation function
+// Computes (base^exponent) % mod efficiently using binary exponentiation + window exponentiation
+// This handles large numbers using BigInt for 512+ bit arithmetic
+BigInt modular_exponentiation(BigInt base, BigInt exponent,const BigInt& mod,
+                              WindowMode mode = WindowMode::sliding);
+
+// Simultaneous exponentiation (Straus, with interleaved sliding windows): result = prod bases[t]^exponents[t]
+// Every base gets its own window width and odd-power table, but they all share one chain of
+// squarings, so a two-term product costs the squarings of a single exponentiation
+// result holds the identity on entry; sqr and mul as for window_exponentiation
+// Reference: B. Moller, "Algorithms for Multi-exponentiation" (SAC 2001)
+template <class T, class Sqr, class Mul>
+void interleaved_exponentiation(const std::vector<BigInt>& exponents, const std::vector<T>& bases, T& result, Sqr sqr, Mul mul) {
+    struct Window {
+        int low;  // Multiply once the squarings reach this bit
+        int u;    // By pre[t][u], u odd
+    };
+    size_t count = bases.size();
+    thread_local std::vector<std::vector<T>> pre;  // Reused across calls, as in window_exponentiation
+    if (pre.size() < count)
+        pre.resize(count);
+    std::vector<std::vector<Window>> windows(count);
+
+    int top = 0;
+    for (size_t t = 0; t < count; t++) {
+        const BigInt& e = exponents[t];
+        int bits = e.bitLength();
+        int W = window_size(bits, WindowMode::sliding);
+        top = std::max(top, bits);
+
+        if ((int)pre[t].size() < (1 << W))
+            pre[t].resize(1 << W);
+        pre[t][1] = bases[t];
+        if (W > 1) {
+            T base2 = bases[t];
+            sqr(base2);
+            for (int u = 3; u < (1 << W); u += 2) {
+                pre[t][u] = pre[t][u - 2];
+                mul(pre[t][u], base2);
+            }
+        }
+
+        // Same windows as the sliding scan of window_exponentiation, highest first
+        for (int i = bits - 1; i >= 0;) {
+            if (!e.testBit(i)) {
+                --i;
+                continue;
+            }
+            int j = std::max(0, i - W + 1);
+            while (!e.testBit(j)) {
+                ++j;
+            }
+            int u = 0;
+            for (int k = i; k >= j; --k) {
+                u = (u << 1) | (int)e.testBit(k);
+            }
+            windows[t].push_back({j, u});
+            i = j - 1;
+        }
+    }
+
+    std::vector<size_t> next(count, 0);  // Next window of each exponent
+    bool started = false;                // Until the first multiply result is the identity: no squaring
+    for (int i = top - 1; i >= 0; --i) {
+        if (started) {
+            sqr(result);
+        }
+        for (size_t t = 0; t < count; t++) {
+            if (next[t] < windows[t].size() && windows[t][next[t]].low == i) {
+                const T& factor = pre[t][windows[t][next[t]].u];
+                if (started) {
+                    mul(result, factor);
+                }
+                else {
+                    result = factor;
+                    started = true;
+                }
+                next[t]++;
+            }
+        }
+    }
+}
+
+// Computes prod bases[t]^exponents[t] % mod (e.g. g^a * y^b for signature checks) with a single
+// chain of squarings; exponents must be non-negative
+BigInt multi_exponentiation(const std::vector<BigInt>& bases, const std::vector<BigInt>& exponents, const BigInt& mod);
+
+#endif
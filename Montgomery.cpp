@@ -0,0 +1,205 @@
+#include "Montgomery.h"
+
+#include <algorithm>
+
+bool Montgomery::supports(const BigInt& modulus) {
+    // base = 2^32, so any odd p works
+    return modulus > 1 && modulus % 2 != 0;
+}
+
+Montgomery::Montgomery(const BigInt& modulus) : m(modulus), mod(modulus.z.begin(), modulus.z.end()), n((int)modulus.z.size()) {
+    assert(supports(modulus));
+
+    // Newton iteration for p^-1 mod 2^32: each step doubles the number of correct bits
+    limb inv = mod[0];
+    for (int i = 0; i < 4; i++)
+        inv *= 2 - mod[0] * inv;
+    m_inv = 0 - inv;
+
+    norm_shift = 0;
+    while (!(mod[n - 1] << norm_shift >> (limb_bits - 1)))
+        norm_shift++;
+    mod_top = mod[n - 1] << norm_shift;
+    if (norm_shift && n > 1)
+        mod_top |= mod[n - 2] >> (limb_bits - norm_shift);
+
+    // R mod p and R^2 mod p are the only divisions this context ever does
+    BigInt r;
+    r.z.assign(n, 0);
+    r.z.push_back(1);
+    BigInt r2;
+    r2.z.assign(2 * n, 0);
+    r2.z.push_back(1);
+    r = r % m;
+    r_mod.assign(r.z.begin(), r.z.end());
+    r_mod.resize(n);
+    r2 = r2 % m;
+    r2_mod.assign(r2.z.begin(), r2.z.end());
+    r2_mod.resize(n);
+}
+
+MontValue Montgomery::to_mont(const BigInt& x) const {
+    BigInt v = x;
+    if (v < 0 || v >= m) {
+        v %= m;
+        if (v < 0)
+            v += m;
+    }
+    MontValue a(v.z.begin(), v.z.end());
+    a.resize(n);
+    mul(a, a, r2_mod);
+    return a;
+}
+
+BigInt Montgomery::from_mont(const MontValue& x) const {
+    MontValue unit(n);
+    unit[0] = 1;
+    mul(unit, x, unit);
+    BigInt res;
+    res.z.assign(unit.begin(), unit.end());
+    res.trim();
+    return res;
+}
+
+// CIOS: interleave one row of a * b with one limb of reduction, t stays below 2p
+void Montgomery::mul(MontValue& out, const MontValue& a, const MontValue& b) const {
+    thread_local vector<limb> t;
+    t.assign(n + 2, 0);
+    for (int i = 0; i < n; i++) {
+        dlimb ai = a[i], carry = 0, cur;
+        for (int j = 0; j < n; j++) {
+            cur = t[j] + ai * b[j] + carry;
+            carry = cur >> limb_bits;
+            t[j] = (limb)cur;
+        }
+        cur = t[n] + carry;
+        t[n] = (limb)cur;
+        t[n + 1] = (limb)(cur >> limb_bits);
+
+        dlimb u = (limb)(t[0] * m_inv);
+        carry = (t[0] + u * mod[0]) >> limb_bits;
+        for (int j = 1; j < n; j++) {
+            cur = t[j] + u * mod[j] + carry;
+            carry = cur >> limb_bits;
+            t[j - 1] = (limb)cur;
+        }
+        cur = t[n] + carry;
+        t[n - 1] = (limb)cur;
+        t[n] = t[n + 1] + (limb)(cur >> limb_bits);
+    }
+
+    final_subtract(out, t.data());
+}
+
+// Separated operand scanning: the square costs about half of a general product, then n reduction rows
+void Montgomery::sqr(MontValue& out, const MontValue& a) const {
+    thread_local vector<limb> t, scratch;
+    t.resize(2 * n + 1);
+    scratch.resize(limbs_sqr_scratch(n));
+    limbs_sqr(t.data(), a.data(), n, scratch.data());
+    t[2 * n] = 0;
+
+    dlimb hi = 0;  // Carry out of t[i + n], owed to t[i + n + 1]
+    for (int i = 0; i < n; i++) {
+        dlimb u = (limb)(t[i] * m_inv), carry = 0, cur;
+        for (int j = 0; j < n; j++) {
+            cur = t[i + j] + u * mod[j] + carry;
+            carry = cur >> limb_bits;
+            t[i + j] = (limb)cur;
+        }
+        cur = t[i + n] + carry + hi;
+        t[i + n] = (limb)cur;
+        hi = cur >> limb_bits;
+    }
+    t[2 * n] = (limb)hi;
+    final_subtract(out, t.data() + n);
+}
+
+// t = a * s < s * p, so the quotient t / p is below s: estimate it from the top two limbs of t and
+// the top limb of p, both normalized (Knuth D, one digit), then fix the remainder up
+void Montgomery::mul_small(MontValue& out, const MontValue& a, limb s) const {
+    thread_local vector<limb> t;
+    t.resize(n + 1);
+    dlimb carry = 0;
+    for (int j = 0; j < n; j++) {
+        carry += (dlimb)a[j] * s;
+        t[j] = (limb)carry;
+        carry >>= limb_bits;
+    }
+    t[n] = (limb)carry;
+    if (s <= 2) {  // Already below 2p
+        final_subtract(out, t.data());
+        return;
+    }
+
+    int sh = norm_shift;
+    limb below = n > 1 ? t[n - 2] : 0;
+    limb hi = sh ? t[n] << sh | t[n - 1] >> (limb_bits - sh) : t[n];
+    limb lo = sh ? t[n - 1] << sh | below >> (limb_bits - sh) : t[n - 1];
+    dlimb q = std::min<dlimb>((((dlimb)hi << limb_bits) | lo) / mod_top, s);  // At most 2 too large
+
+    dlimb borrow = 0;
+    carry = 0;
+    for (int j = 0; j < n; j++) {
+        carry += q * mod[j];
+        dlimb cur = (dlimb)t[j] - (limb)carry - borrow;
+        t[j] = (limb)cur;
+        borrow = cur >> 63;
+        carry >>= limb_bits;
+    }
+    t[n] = (limb)(t[n] - carry - borrow);
+    while (t[n] != 0) {  // Negative: add p back
+        carry = 0;
+        for (int j = 0; j < n; j++) {
+            carry += (dlimb)t[j] + mod[j];
+            t[j] = (limb)carry;
+            carry >>= limb_bits;
+        }
+        t[n] += (limb)carry;
+    }
+    out.assign(t.begin(), t.begin() + n);
+}
+
+void Montgomery::add(MontValue& out, const MontValue& a, const MontValue& b) const {
+    thread_local vector<limb> t;
+    t.resize(n + 1);
+    t[n] = limbs_add(t.data(), a.data(), n, b.data(), n);
+    final_subtract(out, t.data());
+}
+
+void Montgomery::sub(MontValue& out, const MontValue& a, const MontValue& b) const {
+    out.resize(n);
+    if (limbs_sub(out.data(), a.data(), n, b.data(), n))
+        limbs_add(out.data(), out.data(), n, mod.data(), n);
+}
+
+// p is odd, so exactly one of a and a + p is even
+void Montgomery::half(MontValue& out, const MontValue& a) const {
+    thread_local vector<limb> t;
+    t.assign(a.begin(), a.end());
+    limb top = a[0] & 1 ? limbs_add(t.data(), t.data(), n, mod.data(), n) : 0;
+    out.resize(n);
+    for (int j = 0; j < n - 1; j++)
+        out[j] = t[j] >> 1 | t[j + 1] << (limb_bits - 1);
+    out[n - 1] = t[n - 1] >> 1 | top << (limb_bits - 1);
+}
+
+// t in [0, 2p): at most one subtraction
+void Montgomery::final_subtract(MontValue& out, const limb* t) const {
+    bool ge = t[n] != 0;
+    if (!ge) {
+        ge = true;
+        for (int j = n - 1; j >= 0; j--)
+            if (t[j] != mod[j]) {
+                ge = t[j] > mod[j];
+                break;
+            }
+    }
+    out.resize(n);
+    dlimb borrow = 0;
+    for (int j = 0; j < n; j++) {
+        dlimb cur = (dlimb)t[j] - (ge ? mod[j] : 0) - borrow;
+        borrow = cur >> 63;
+        out[j] = (limb)cur;
+    }
+}
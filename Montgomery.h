@@ -0,0 +1,54 @@
+// Montgomery modular multiplication for BigInt
+// Reference: P. L. Montgomery, "Modular Multiplication Without Trial Division" (1985)
+// Reference: C. K. Koc et al., "Analyzing and Comparing Montgomery Multiplication Algorithms" (CIOS)
+
+#ifndef Montgomery_H
+#define Montgomery_H
+
+#include "BigInt.h"
+
+// A residue in Montgomery form: exactly size() limbs, value < modulus
+using MontValue = vector<limb>;
+
+class Montgomery {
+private:
+    BigInt m;          // Modulus p
+    vector<limb> mod;  // Limbs of p
+    int n;             // Number of limbs, R = 2^(32n)
+    limb m_inv;        // -p^-1 mod 2^32
+    MontValue r_mod;   // R mod p (Montgomery form of 1)
+    MontValue r2_mod;  // R^2 mod p (used to enter Montgomery form)
+    int norm_shift;    // Leading zero bits of the top limb of p
+    limb mod_top;      // Top 32 bits of p shifted left by norm_shift, for quotient estimates
+
+    void final_subtract(MontValue& out, const limb* t) const;  // out = t mod p for an (n + 1)-limb t < 2p
+
+public:
+    using Value = MontValue;
+
+    explicit Montgomery(const BigInt& modulus);  // Built once per modulus
+
+    static bool supports(const BigInt& modulus);  // modulus > 1 and odd
+
+    const BigInt& modulus() const { return m; }
+    int size() const { return n; }
+    const MontValue& one() const { return r_mod; }
+
+    MontValue to_mont(const BigInt& x) const;    // x * R mod p
+    BigInt from_mont(const MontValue& x) const;  // x * R^-1 mod p
+
+    // out = a * b * R^-1 mod p, fused multiply-reduce; out may alias a or b
+    void mul(MontValue& out, const MontValue& a, const MontValue& b) const;
+    // out = a^2 * R^-1 mod p; squares first (cross products once), then reduces; out may alias a
+    void sqr(MontValue& out, const MontValue& a) const;
+    // out = a * s mod p for a single-limb s, in linear time; a factor outside Montgomery form keeps
+    // the result in it. s = 2 is a shift and a conditional subtract; out may alias a
+    void mul_small(MontValue& out, const MontValue& a, limb s) const;
+
+    // Linear-time residue arithmetic, the same in and out of Montgomery form; out may alias a or b
+    void add(MontValue& out, const MontValue& a, const MontValue& b) const;  // a + b mod p
+    void sub(MontValue& out, const MontValue& a, const MontValue& b) const;  // a - b mod p
+    void half(MontValue& out, const MontValue& a) const;                     // a / 2 mod p
+};
+
+#endif
@@ -0,0 +1,40 @@
+// Uniform random BigInts in a closed range [a, b]
+// Rejection sampling on masked random limbs: draw bitLength(b - a) random bits and retry while the
+// draw exceeds b - a. At least half of all draws are accepted, so the expected cost is under two
+// draws of a few RNG words each, with no division (taking a wider draw modulo the range needs a
+// full divmod and is still slightly biased)
+// Reference: D. Lemire, "Fast Random Integer Generation in an Interval" (2019)
+
+#ifndef UniformBigInt_H
+#define UniformBigInt_H
+
+#include "BigInt.h"
+
+#include <cassert>
+
+// Built once per range, like std::uniform_int_distribution; works with any generator of 64-bit words
+class UniformBigIntDistribution {
+public:
+    UniformBigIntDistribution(const BigInt& a, const BigInt& b) : lo(a), hi(b), span(b - a), bits(span.bitLength()) {
+        assert(a <= b);
+    }
+
+    template <class Rng>
+    BigInt operator()(Rng& rng) const {
+        while (true) {
+            BigInt x = BigInt::random_bits(rng, bits);
+            if (x <= span)
+                return x + lo;
+        }
+    }
+
+    const BigInt& a() const { return lo; }
+    const BigInt& b() const { return hi; }
+
+private:
+    BigInt lo, hi;
+    BigInt span;  // b - a, the largest accepted draw
+    int bits;     // Random bits per draw: bitLength(b - a)
+};
+
+#endif
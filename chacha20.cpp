@@ -0,0 +1,120 @@
+#include "chacha20.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <random>
+
+// Out-of-line definitions for the constants bound to references (required before C++17)
+constexpr int ChaChaRng::buffer_blocks;
+constexpr size_t ChaChaRng::reseed_bytes;
+constexpr int ChaChaRng::reseed_seconds;
+constexpr int ChaChaRng::buffer_words;
+
+static inline uint32_t rotl(uint32_t x, int n) {
+    return x << n | x >> (32 - n);
+}
+
+static inline void quarter_round(uint32_t* s, int a, int b, int c, int d) {
+    s[a] += s[b]; s[d] ^= s[a]; s[d] = rotl(s[d], 16);
+    s[c] += s[d]; s[b] ^= s[c]; s[b] = rotl(s[b], 12);
+    s[a] += s[b]; s[d] ^= s[a]; s[d] = rotl(s[d], 8);
+    s[c] += s[d]; s[b] ^= s[c]; s[b] = rotl(s[b], 7);
+}
+
+void chacha20_block(const uint32_t key[8], uint32_t counter, const uint32_t nonce[3], uint32_t out[16]) {
+    uint32_t s[16] = {0x61707865, 0x3320646e, 0x79622d32, 0x6b206574};  // "expand 32-byte k"
+    std::memcpy(s + 4, key, 8 * sizeof(uint32_t));
+    s[12] = counter;
+    std::memcpy(s + 13, nonce, 3 * sizeof(uint32_t));
+
+    uint32_t x[16];
+    std::memcpy(x, s, sizeof(x));
+    for (int i = 0; i < 10; i++) {  // 20 rounds: a column round and a diagonal round per step
+        quarter_round(x, 0, 4, 8, 12);
+        quarter_round(x, 1, 5, 9, 13);
+        quarter_round(x, 2, 6, 10, 14);
+        quarter_round(x, 3, 7, 11, 15);
+        quarter_round(x, 0, 5, 10, 15);
+        quarter_round(x, 1, 6, 11, 12);
+        quarter_round(x, 2, 7, 8, 13);
+        quarter_round(x, 3, 4, 9, 14);
+    }
+    for (int i = 0; i < 16; i++)
+        out[i] = x[i] + s[i];
+}
+
+// 32 bytes from /dev/urandom, or from random_device where that file does not exist
+static void os_entropy(uint32_t out[8]) {
+    std::ifstream urandom("/dev/urandom", std::ios::binary);
+    if (urandom.read(reinterpret_cast<char*>(out), 8 * sizeof(uint32_t)))
+        return;
+    std::random_device rd;
+    for (int i = 0; i < 8; i++)
+        out[i] = rd();
+}
+
+ChaChaRng::ChaChaRng() {
+    std::memset(key, 0, sizeof(key));
+    reseed();
+}
+
+ChaChaRng::~ChaChaRng() {
+    // Leave no key or unread output behind in freed memory
+    volatile uint32_t* p = key;
+    for (int i = 0; i < 8; i++)
+        p[i] = 0;
+    p = buf;
+    for (int i = 0; i < buffer_words; i++)
+        p[i] = 0;
+}
+
+ChaChaRng& ChaChaRng::thread_instance() {
+    thread_local ChaChaRng rng;
+    return rng;
+}
+
+// XOR keeps whatever entropy the old key had; buffered output from the old key is discarded
+void ChaChaRng::reseed() {
+    uint32_t fresh[8];
+    os_entropy(fresh);
+    for (int i = 0; i < 8; i++)
+        key[i] ^= fresh[i];
+    drawn = 0;
+    seeded_at = std::chrono::steady_clock::now();
+    refill();
+}
+
+// Nonce zero and counters from 0 are safe because every refill runs under a new key
+void ChaChaRng::refill() {
+    const uint32_t nonce[3] = {0, 0, 0};
+    for (int b = 0; b < buffer_blocks; b++)
+        chacha20_block(key, b, nonce, buf + 16 * b);
+    std::memcpy(key, buf, sizeof(key));
+    std::memset(buf, 0, sizeof(key));
+    pos = 8;
+}
+
+void ChaChaRng::fill(uint32_t* out, size_t n) {
+    while (n > 0) {
+        if (pos == buffer_words) {
+            if (drawn >= reseed_bytes || std::chrono::steady_clock::now() - seeded_at >= std::chrono::seconds(reseed_seconds))
+                reseed();
+            else
+                refill();
+        }
+        size_t take = std::min(n, (size_t)(buffer_words - pos));
+        std::memcpy(out, buf + pos, take * sizeof(uint32_t));
+        std::memset(buf + pos, 0, take * sizeof(uint32_t));
+        pos += (int)take;
+        out += take;
+        n -= take;
+        drawn += take * sizeof(uint32_t);
+    }
+}
+
+ChaChaRng::result_type ChaChaRng::operator()() {
+    uint32_t w[2];
+    fill(w, 2);
+    return (result_type)w[1] << 32 | w[0];
+}
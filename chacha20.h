@@ -0,0 +1,54 @@
+// ChaCha20-based deterministic random bit generator, seeded from the operating system
+// Keystream is produced a buffer at a time, so most draws are a copy out of memory; after every
+// refill the first 32 bytes of fresh keystream become the next key (fast key erasure), so a
+// captured state does not reveal earlier output
+// The key is remixed with new OS entropy once reseed_bytes have been drawn or reseed_seconds have passed
+// Reference: RFC 8439, "ChaCha20 and Poly1305 for IETF Protocols"
+// Reference: D. J. Bernstein, "Fast-key-erasure random-number generators" (2017)
+
+#ifndef CHACHA20_H
+#define CHACHA20_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// One 64-byte ChaCha20 block (RFC 8439, section 2.3) for a 256-bit key, block counter and 96-bit nonce
+void chacha20_block(const uint32_t key[8], uint32_t counter, const uint32_t nonce[3], uint32_t out[16]);
+
+class ChaChaRng {
+public:
+    using result_type = uint64_t;  // Usable wherever a UniformRandomBitGenerator is expected
+
+    static constexpr int buffer_blocks = 8;                   // Keystream blocks per refill (512 bytes)
+    static constexpr size_t reseed_bytes = size_t(1) << 30;   // Output between reseeds
+    static constexpr int reseed_seconds = 300;
+
+    ChaChaRng();  // Keyed from /dev/urandom
+    ~ChaChaRng();
+    ChaChaRng(const ChaChaRng&) = delete;
+    ChaChaRng& operator=(const ChaChaRng&) = delete;
+
+    // The generator of the calling thread, keyed on first use; no locking, no sharing
+    static ChaChaRng& thread_instance();
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return ~result_type(0); }
+    result_type operator()();
+
+    void fill(uint32_t* out, size_t n);  // n words of output in one call
+    void reseed();                       // Mix fresh OS entropy into the key now
+
+private:
+    static constexpr int buffer_words = 16 * buffer_blocks;
+
+    uint32_t key[8];
+    uint32_t buf[buffer_words];
+    int pos;                  // Next unused word of buf
+    size_t drawn;             // Bytes output since the last reseed
+    std::chrono::steady_clock::time_point seeded_at;
+
+    void refill();
+};
+
+#endif
@@ -1,33 +1,61 @@
 #include "fft.h"
 
-vector<cpx> roots = { {0, 0}, {1, 0} };
+#include <memory>
+#include <mutex>
 
-void ensure_capacity(int min_capacity) {
-    for (int len = roots.size(); len < min_capacity; len *= 2) {
-        for (int i = len >> 1; i < len; i++) {
-            roots.emplace_back(roots[i]);
-            double angle = 2 * PI * (2 * i + 1 - len) / (len * 2);
-            roots.emplace_back(cos(angle), sin(angle));
+static const int MAX_LOG = 30;
+static once_flag plan_once[MAX_LOG + 1];
+static unique_ptr<const FFTPlan> plans[MAX_LOG + 1];
+
+static unique_ptr<const FFTPlan> make_plan(int n) {
+    unique_ptr<FFTPlan> plan(new FFTPlan());
+    plan->n = n;
+    plan->roots.assign(max(n, 2), cpx(0, 0));
+    plan->roots[1] = cpx(1, 0);
+    for (int len = 2; len < n; len <<= 1) {
+        for (int j = 0; j < len; j++) {
+            double angle = PI * j / len;
+            plan->roots[len + j] = cpx(cos(angle), sin(angle));
         }
     }
+    plan->rev.assign(n, 0);
+    for (int i = 1, j = 0; i < n; i++) {
+        int bit = n >> 1;
+        for (; j & bit; bit >>= 1)
+            j ^= bit;
+        j ^= bit;
+        plan->rev[i] = j;
+    }
+    return plan;
+}
+
+const FFTPlan& fft_plan(int n) {
+    assert(n > 0 && (n & (n - 1)) == 0);
+    int k = 0;
+    while ((1 << k) < n)
+        k++;
+    assert(k <= MAX_LOG);
+    call_once(plan_once[k], [n, k] { plans[k] = make_plan(n); });
+    return *plans[k];
+}
+
+void fft_warmup(int max_size) {
+    for (int k = 0; k <= MAX_LOG && (1 << k) <= max_size; k++)
+        fft_plan(1 << k);
 }
 
 void fft(vector<cpx>& z, bool inverse) {
     int n = z.size();
-    assert((n & (n - 1)) == 0);
-    ensure_capacity(n);
-    for (unsigned i = 1, j = 0; i < n; i++) {
-        int bit = n >> 1;
-        for (; j >= bit; bit >>= 1)
-            j -= bit;
-        j += bit;
+    const FFTPlan& plan = fft_plan(n);
+    for (int i = 1; i < n; i++) {
+        int j = plan.rev[i];
         if (i < j)
             swap(z[i], z[j]);
     }
     for (int len = 1; len < n; len <<= 1) {
         for (int i = 0; i < n; i += len * 2) {
             for (int j = 0; j < len; j++) {
-                cpx root = inverse ? conj(roots[j + len]) : roots[j + len];
+                cpx root = inverse ? conj(plan.roots[j + len]) : plan.roots[j + len];
                 cpx u = z[i + j];
                 cpx v = z[i + j + len] * root;
                 z[i + j] = u + v;
@@ -69,6 +97,47 @@ vector<int> multiply_bigint(const vector<int>& a, const vector<int>& b, int base
     return result;
 }
 
+// Real-input square: the 2m digits are packed as m complex points z[j] = a[2j] + i*a[2j+1],
+// so both transforms run at half the length of multiply_bigint
+// A[k] = E[k] + w^k O[k], A[k+m] = E[k] - w^k O[k] with E, O the spectra of the even / odd digits
+vector<int> square_bigint(const vector<int>& a, int base) {
+    int need = 2 * a.size();
+    int n = 2;
+    while (n < need)
+        n <<= 1;
+    int m = n / 2;
+    const vector<cpx>& w = fft_plan(n).roots;  // w[m + k] = e^(2*pi*i*k/n)
+    vector<cpx> z(m);
+    for (size_t i = 0; i < a.size(); i++) {
+        if (i & 1)
+            z[i / 2].imag(a[i]);
+        else
+            z[i / 2].real(a[i]);
+    }
+    fft(z, false);
+    vector<cpx> y(m);
+    for (int k = 0; k < m; k++) {
+        int j = (m - k) & (m - 1);
+        cpx e = (z[k] + conj(z[j])) * 0.5;
+        cpx o = (z[k] - conj(z[j])) * cpx(0, -0.5);
+        cpx lo = e + w[m + k] * o, hi = e - w[m + k] * o;
+        lo *= lo;
+        hi *= hi;
+        // Repack the square's spectrum into the even / odd halves of the result
+        y[k] = (lo + hi) * 0.5 + cpx(0, 1) * ((lo - hi) * 0.5 * conj(w[m + k]));
+    }
+    fft(y, true);
+    vector<int> result(need);
+    long long carry = 0;
+    for (int i = 0; i < need; i++) {
+        double v = i & 1 ? y[i / 2].imag() : y[i / 2].real();
+        long long d = (long long)(v + 0.5) + carry;
+        carry = d / base;
+        result[i] = d % base;
+    }
+    return result;
+}
+
 vector<int> multiply_mod(const vector<int>& a, const vector<int>& b, int m) {
     int need = a.size() + b.size() - 1;
     int n = 1;
@@ -16,11 +16,20 @@ using namespace std;
 
 using cpx = complex<double>;
 const double PI = acos(-1);
-extern vector<cpx> roots;
 
-inline void ensure_capacity(int);
-inline void fft(vector<cpx>&, bool);
+// Immutable tables for one power-of-two transform size, built once and shared read-only across threads
+struct FFTPlan {
+    int n;
+    vector<cpx> roots;  // roots[len + j] = e^(i*pi*j/len) for len = 1, 2, 4, ..., n/2
+    vector<int> rev;    // Bit-reversal permutation
+};
+
+const FFTPlan& fft_plan(int n);  // Thread-safe, built on first use
+void fft_warmup(int max_size);   // Build every plan up to max_size ahead of time (e.g. at startup)
+
+void fft(vector<cpx>&, bool);
 extern vector<int> multiply_bigint(const vector<int>&, const vector<int>&, int);
+extern vector<int> square_bigint(const vector<int>&, int);  // a * a with half-length transforms
 inline vector<int> multiply_mod(const vector<int>&, const vector<int>&, int);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,74 @@
+#include "limb_arena.h"
+
+#include <atomic>
+#include <new>
+
+using namespace std;
+
+struct alignas(16) ArenaChunk {
+    atomic<long> refs;  // Live blocks, plus one while the chunk is its arena's current chunk
+    size_t capacity, used;
+};
+
+// Every block starts with a header naming its chunk (nullptr for operator new blocks)
+struct alignas(16) BlockHeader {
+    ArenaChunk* chunk;
+};
+
+static thread_local LimbArena* current_arena = nullptr;
+
+static void release_chunk(ArenaChunk* c) {
+    if (c && c->refs.fetch_sub(1, memory_order_acq_rel) == 1) {
+        c->~ArenaChunk();
+        ::operator delete(c);
+    }
+}
+
+LimbArena::LimbArena(size_t chunk_bytes) : chunk(nullptr), chunk_bytes(chunk_bytes) {}
+
+LimbArena::~LimbArena() {
+    release_chunk(chunk);
+}
+
+limb* LimbArena::allocate(size_t n) {
+    size_t bytes = (sizeof(BlockHeader) + n * sizeof(limb) + 15) & ~size_t(15);
+    if (bytes > chunk_bytes / 4)
+        return nullptr;
+    if (!chunk || chunk->used + bytes > chunk->capacity) {
+        release_chunk(chunk);
+        chunk = new (::operator new(sizeof(ArenaChunk) + chunk_bytes)) ArenaChunk();
+        chunk->refs.store(1, memory_order_relaxed);
+        chunk->capacity = chunk_bytes;
+        chunk->used = 0;
+    }
+    BlockHeader* h = (BlockHeader*)((char*)(chunk + 1) + chunk->used);
+    chunk->used += bytes;
+    chunk->refs.fetch_add(1, memory_order_relaxed);
+    h->chunk = chunk;
+    return (limb*)(h + 1);
+}
+
+LimbArenaScope::LimbArenaScope(LimbArena& arena) : previous(current_arena) {
+    current_arena = &arena;
+}
+
+LimbArenaScope::~LimbArenaScope() {
+    current_arena = previous;
+}
+
+limb* limb_alloc(size_t n) {
+    if (current_arena)
+        if (limb* p = current_arena->allocate(n))
+            return p;
+    BlockHeader* h = (BlockHeader*)::operator new(sizeof(BlockHeader) + n * sizeof(limb));
+    h->chunk = nullptr;
+    return (limb*)(h + 1);
+}
+
+void limb_free(limb* p) {
+    BlockHeader* h = (BlockHeader*)p - 1;
+    if (h->chunk)
+        release_chunk(h->chunk);
+    else
+        ::operator delete(h);
+}
@@ -0,0 +1,52 @@
+// Arena allocation for limb buffers
+// A LimbArenaScope routes every LimbVector heap block allocated on this thread into a bump arena:
+// no global allocator lock, and a whole batch of temporaries goes back in one piece
+// Blocks may outlive the scope (e.g. a returned result): each chunk counts its live blocks and
+// is freed when the last of them is, wherever that happens
+// Only numbers past LimbVector's inline capacity (over 4096 bits) have heap blocks at all, so this
+// is for batches of long arithmetic, e.g. 8192-bit and larger operands or the NTT/FFT-size
+// products; DH-size values (prime search, handshakes) live inline and never reach the arena
+
+#ifndef LIMB_ARENA_H
+#define LIMB_ARENA_H
+
+#include "limbs.h"
+
+#include <cstddef>
+
+struct ArenaChunk;
+
+class LimbArena {
+private:
+    ArenaChunk* chunk;   // Current chunk; the arena holds one reference on it
+    size_t chunk_bytes;  // Size of each new chunk
+
+public:
+    explicit LimbArena(size_t chunk_bytes = 1 << 16);
+    ~LimbArena();
+    LimbArena(const LimbArena&) = delete;
+    LimbArena& operator=(const LimbArena&) = delete;
+
+    // n limbs, or nullptr when the block is too big for a chunk (the caller uses the global heap)
+    // Only the thread that owns the arena allocates from it
+    limb* allocate(size_t n);
+};
+
+// Makes arena the allocator of this thread's limb buffers until the scope ends; scopes nest
+class LimbArenaScope {
+private:
+    LimbArena* previous;
+
+public:
+    explicit LimbArenaScope(LimbArena& arena);
+    ~LimbArenaScope();
+    LimbArenaScope(const LimbArenaScope&) = delete;
+    LimbArenaScope& operator=(const LimbArenaScope&) = delete;
+};
+
+// Heap blocks for LimbVector: from the thread's arena when a scope is active, otherwise operator new
+// limb_free works from any thread and for blocks of either origin
+limb* limb_alloc(size_t n);
+void limb_free(limb* p);
+
+#endif
@@ -0,0 +1,161 @@
+// Limb storage with a small-buffer optimization
+// Up to inline_capacity limbs (4096 bits) live inside the object itself, so small and
+// cryptographic-size BigInts never touch the heap; longer numbers spill to a heap block
+// Heap blocks come from limb_alloc, so an active LimbArenaScope serves them from its arena
+// Reference: https://llvm.org/doxygen/classllvm_1_1SmallVector.html
+
+#ifndef LIMB_VECTOR_H
+#define LIMB_VECTOR_H
+
+#include "limbs.h"
+#include "limb_arena.h"
+
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+class LimbVector {
+    // Keeps assign(n, value) with int arguments away from the iterator overloads
+    template <class It>
+    using if_iterator = typename std::enable_if<!std::is_integral<It>::value>::type;
+
+public:
+    static constexpr int inline_capacity = 128;
+
+    using value_type = limb;
+    using iterator = limb*;
+    using const_iterator = const limb*;
+
+    LimbVector() : ptr(buf), len(0), cap(inline_capacity) {}
+    explicit LimbVector(size_t n, limb value = 0) : LimbVector() { assign(n, value); }
+    template <class It, class = if_iterator<It>>
+    LimbVector(It first, It last) : LimbVector() { assign(first, last); }
+    LimbVector(const std::vector<limb>& v) : LimbVector() { assign(v.begin(), v.end()); }
+
+    LimbVector(const LimbVector& other) : LimbVector() { assign(other.begin(), other.end()); }
+    LimbVector(LimbVector&& other) noexcept : LimbVector() { steal(other); }
+    LimbVector& operator=(const LimbVector& other) {
+        if (this != &other)
+            assign(other.begin(), other.end());
+        return *this;
+    }
+    LimbVector& operator=(LimbVector&& other) noexcept {
+        if (this != &other) {
+            release();
+            steal(other);
+        }
+        return *this;
+    }
+    ~LimbVector() { release(); }
+
+    size_t size() const { return len; }
+    size_t capacity() const { return cap; }
+    bool empty() const { return len == 0; }
+    bool is_inline() const { return ptr == buf; }
+
+    limb* data() { return ptr; }
+    const limb* data() const { return ptr; }
+    limb& operator[](size_t i) { return ptr[i]; }
+    const limb& operator[](size_t i) const { return ptr[i]; }
+    limb& back() { return ptr[len - 1]; }
+    const limb& back() const { return ptr[len - 1]; }
+    iterator begin() { return ptr; }
+    iterator end() { return ptr + len; }
+    const_iterator begin() const { return ptr; }
+    const_iterator end() const { return ptr + len; }
+
+    // Capacity never shrinks, as with std::vector
+    void reserve(size_t n) {
+        if (n <= cap)
+            return;
+        size_t new_cap = std::max(n, 2 * (size_t)cap);
+        limb* p = limb_alloc(new_cap);
+        std::memcpy(p, ptr, len * sizeof(limb));
+        release();
+        ptr = p;
+        cap = (uint32_t)new_cap;
+    }
+    void resize(size_t n) {
+        reserve(n);
+        if (n > len)
+            std::fill(ptr + len, ptr + n, 0);
+        len = (uint32_t)n;
+    }
+    void clear() { len = 0; }
+    void push_back(limb v) {
+        if (len == cap)
+            reserve(len + 1);
+        ptr[len++] = v;
+    }
+    void pop_back() { len--; }
+
+    void assign(size_t n, limb value) {
+        reserve(n);
+        std::fill(ptr, ptr + n, value);
+        len = (uint32_t)n;
+    }
+    template <class It, class = if_iterator<It>>
+    void assign(It first, It last) {
+        size_t n = std::distance(first, last);
+        reserve(n);
+        std::copy(first, last, ptr);
+        len = (uint32_t)n;
+    }
+
+    iterator insert(const_iterator pos, size_t count, limb value) {
+        size_t at = pos - ptr;
+        reserve(len + count);
+        std::memmove(ptr + at + count, ptr + at, (len - at) * sizeof(limb));
+        std::fill(ptr + at, ptr + at + count, value);
+        len += (uint32_t)count;
+        return ptr + at;
+    }
+    iterator erase(const_iterator first, const_iterator last) {
+        size_t at = first - ptr, count = last - first;
+        std::memmove(ptr + at, ptr + at + count, (len - at - count) * sizeof(limb));
+        len -= (uint32_t)count;
+        return ptr + at;
+    }
+
+    // O(1) when both sides are on the heap, otherwise the inline limbs are copied
+    void swap(LimbVector& other) {
+        LimbVector tmp(std::move(other));
+        other = std::move(*this);
+        *this = std::move(tmp);
+    }
+
+    friend bool operator==(const LimbVector& a, const LimbVector& b) {
+        return a.len == b.len && std::equal(a.begin(), a.end(), b.begin());
+    }
+    friend bool operator!=(const LimbVector& a, const LimbVector& b) { return !(a == b); }
+
+private:
+    limb* ptr;
+    uint32_t len, cap;
+    limb buf[inline_capacity];
+
+    void release() {
+        if (!is_inline())
+            limb_free(ptr);
+        ptr = buf;
+        cap = inline_capacity;
+    }
+    // Take over other's limbs; other is left empty and inline
+    void steal(LimbVector& other) {
+        if (other.is_inline()) {
+            std::memcpy(buf, other.buf, other.len * sizeof(limb));
+            ptr = buf;
+            cap = inline_capacity;
+        } else {
+            ptr = other.ptr;
+            cap = other.cap;
+            other.ptr = other.buf;
+            other.cap = inline_capacity;
+        }
+        len = other.len;
+        other.len = 0;
+    }
+};
+
+#endif
@@ -0,0 +1,378 @@
+#include "limbs.h"
+
+#include <algorithm>
+
+using namespace std;
+
+limb limbs_add(limb* r, const limb* a, int na, const limb* b, int nb) {
+    dlimb carry = 0;
+    int i = 0;
+    for (; i < nb; i++) {
+        carry += (dlimb)a[i] + b[i];
+        r[i] = (limb)carry;
+        carry >>= limb_bits;
+    }
+    for (; i < na; i++) {
+        carry += a[i];
+        r[i] = (limb)carry;
+        carry >>= limb_bits;
+    }
+    return (limb)carry;
+}
+
+limb limbs_sub(limb* r, const limb* a, int na, const limb* b, int nb) {
+    dlimb borrow = 0;
+    int i = 0;
+    for (; i < nb; i++) {
+        dlimb cur = (dlimb)a[i] - b[i] - borrow;
+        r[i] = (limb)cur;
+        borrow = cur >> 63;
+    }
+    for (; i < na; i++) {
+        dlimb cur = (dlimb)a[i] - borrow;
+        r[i] = (limb)cur;
+        borrow = cur >> 63;
+    }
+    return (limb)borrow;
+}
+
+int limbs_cmp(const limb* a, int na, const limb* b, int nb) {
+    while (na > 0 && a[na - 1] == 0)
+        na--;
+    while (nb > 0 && b[nb - 1] == 0)
+        nb--;
+    if (na != nb)
+        return na < nb ? -1 : 1;
+    for (int i = na - 1; i >= 0; i--)
+        if (a[i] != b[i])
+            return a[i] < b[i] ? -1 : 1;
+    return 0;
+}
+
+void limbs_mul_basecase(limb* r, const limb* a, int na, const limb* b, int nb) {
+    fill(r, r + na + nb, 0);
+    for (int i = 0; i < na; i++) {
+        if (!a[i])
+            continue;
+        dlimb carry = 0;
+        for (int j = 0; j < nb; j++) {
+            dlimb cur = r[i + j] + (dlimb)a[i] * b[j] + carry;
+            r[i + j] = (limb)cur;
+            carry = cur >> limb_bits;
+        }
+        r[i + nb] = (limb)carry;
+    }
+}
+
+// Each cross product a[i] a[j] (i < j) is formed once, doubled by one shift, then the diagonal is added
+void limbs_sqr_basecase(limb* r, const limb* a, int n) {
+    fill(r, r + 2 * n, 0);
+    for (int i = 0; i < n; i++) {
+        if (!a[i])
+            continue;
+        dlimb carry = 0;
+        for (int j = i + 1; j < n; j++) {
+            dlimb cur = r[i + j] + (dlimb)a[i] * a[j] + carry;
+            r[i + j] = (limb)cur;
+            carry = cur >> limb_bits;
+        }
+        r[i + n] = (limb)carry;
+    }
+    for (int i = 2 * n - 1; i > 0; i--)
+        r[i] = (r[i] << 1) | (r[i - 1] >> (limb_bits - 1));
+    r[0] <<= 1;
+
+    dlimb carry = 0;
+    for (int i = 0; i < n; i++) {
+        dlimb sq = (dlimb)a[i] * a[i];
+        carry += (dlimb)r[2 * i] + (limb)sq;
+        r[2 * i] = (limb)carry;
+        carry >>= limb_bits;
+        carry += (dlimb)r[2 * i + 1] + (sq >> limb_bits);
+        r[2 * i + 1] = (limb)carry;
+        carry >>= limb_bits;
+    }
+}
+
+// d[0..n) = |x - y| (x, y at most n limbs), returns true when x < y
+static bool limbs_absdiff(limb* d, const limb* x, int nx, const limb* y, int ny, int n) {
+    while (nx > 0 && x[nx - 1] == 0)
+        nx--;
+    while (ny > 0 && y[ny - 1] == 0)
+        ny--;
+    bool neg = limbs_cmp(x, nx, y, ny) < 0;
+    if (neg)
+        limbs_sub(d, y, ny, x, nx);
+    else
+        limbs_sub(d, x, nx, y, ny);
+    fill(d + max(nx, ny), d + n, 0);
+    return neg;
+}
+
+// Two's complement helpers on a fixed width of n limbs
+static void tc_negate(limb* a, int n) {
+    dlimb carry = 1;
+    for (int i = 0; i < n; i++) {
+        carry += (limb)~a[i];
+        a[i] = (limb)carry;
+        carry >>= limb_bits;
+    }
+}
+
+static bool tc_negative(const limb* a, int n) {
+    return a[n - 1] >> (limb_bits - 1);
+}
+
+static void tc_shl1(limb* a, int n) {
+    for (int i = n - 1; i > 0; i--)
+        a[i] = (a[i] << 1) | (a[i - 1] >> (limb_bits - 1));
+    a[0] <<= 1;
+}
+
+static void tc_sar1(limb* a, int n) {
+    for (int i = 0; i < n - 1; i++)
+        a[i] = (a[i] >> 1) | (a[i + 1] << (limb_bits - 1));
+    a[n - 1] = (limb)((int32_t)a[n - 1] >> 1);
+}
+
+// a = a / 3 modulo 2^(32n), exact when 3 divides a (Hensel / Jebelean division)
+static void tc_divexact3(limb* a, int n) {
+    const limb inv3 = 0xAAAAAAABu;  // 3^-1 mod 2^32
+    limb carry = 0;
+    for (int i = 0; i < n; i++) {
+        limb x = a[i];
+        limb borrow = x < carry;
+        limb d = x - carry;
+        limb q = d * inv3;
+        a[i] = q;
+        carry = (limb)(((dlimb)q * 3) >> limb_bits) + borrow;
+    }
+}
+
+// Scratch of the balanced n x n product; the recursion is not monotone in n (Toom-3 on k + 1
+// limbs may need less than Karatsuba on k), so every child size is accounted for
+static int balanced_scratch(int n) {
+    if (n < karatsuba_threshold)
+        return 0;
+    if (n < toom3_threshold) {
+        int h = (n + 1) / 2, l = n - h;
+        return max(6 * h + 1 + balanced_scratch(h), balanced_scratch(l));
+    }
+    int k = (n + 2) / 3, s = n - 2 * k;
+    return 12 * k + 24 + max(balanced_scratch(k + 1), max(balanced_scratch(k), balanced_scratch(s)));
+}
+
+// Same accounting for the n-limb square
+static int sqr_scratch(int n) {
+    if (n < karatsuba_threshold)
+        return 0;
+    if (n < toom3_threshold) {
+        int h = (n + 1) / 2, l = n - h;
+        return max(5 * h + 1 + sqr_scratch(h), sqr_scratch(l));
+    }
+    int k = (n + 2) / 3, s = n - 2 * k;
+    return 9 * k + 18 + max(sqr_scratch(k + 1), max(sqr_scratch(k), sqr_scratch(s)));
+}
+
+int limbs_sqr_scratch(int n) {
+    return sqr_scratch(n);
+}
+
+int limbs_mul_scratch(int na, int nb) {
+    if (na < nb)
+        swap(na, nb);
+    if (nb < karatsuba_threshold)
+        return 0;
+    if (na == nb)
+        return balanced_scratch(nb);
+    int rem = na % nb;
+    return 2 * nb + max(balanced_scratch(nb), rem ? limbs_mul_scratch(nb, rem) : 0);
+}
+
+// Karatsuba, subtractive form: a0 b1 + a1 b0 = z0 + z2 + (a0 - a1)(b1 - b0)
+static void mul_karatsuba(limb* r, const limb* a, const limb* b, int n, limb* ws) {
+    int h = (n + 1) / 2, l = n - h;
+    limbs_mul(r, a, h, b, h, ws);                  // z0 -> r[0..2h)
+    limbs_mul(r + 2 * h, a + h, l, b + h, l, ws);  // z2 -> r[2h..2n)
+
+    limb* da = ws;
+    limb* db = da + h;
+    limb* m = db + h;
+    limb* t = m + 2 * h;
+    limb* next = t + 2 * h + 1;
+    bool neg = limbs_absdiff(da, a, h, a + h, l, h) != limbs_absdiff(db, b + h, l, b, h, h);
+    limbs_mul(m, da, h, db, h, next);
+
+    t[2 * h] = limbs_add(t, r, 2 * h, r + 2 * h, 2 * l);
+    if (neg)
+        limbs_sub(t, t, 2 * h + 1, m, 2 * h);
+    else
+        limbs_add(t, t, 2 * h + 1, m, 2 * h);
+    limbs_add(r + h, r + h, 2 * n - h, t, 2 * h + 1);
+}
+
+// a0^2 + a1^2 - (a0 - a1)^2 = 2 a0 a1: three half-size squares, no sign to track
+static void sqr_karatsuba(limb* r, const limb* a, int n, limb* ws) {
+    int h = (n + 1) / 2, l = n - h;
+    limbs_sqr(r, a, h, ws);              // z0 -> r[0..2h)
+    limbs_sqr(r + 2 * h, a + h, l, ws);  // z2 -> r[2h..2n)
+
+    limb* da = ws;
+    limb* m = da + h;
+    limb* t = m + 2 * h;
+    limb* next = t + 2 * h + 1;
+    limbs_absdiff(da, a, h, a + h, l, h);
+    limbs_sqr(m, da, h, next);
+
+    t[2 * h] = limbs_add(t, r, 2 * h, r + 2 * h, 2 * l);
+    limbs_sub(t, t, 2 * h + 1, m, 2 * h);
+    limbs_add(r + h, r + h, 2 * n - h, t, 2 * h + 1);
+}
+
+// Toom-3 evaluation at 1, -1, -2 into (k + 2)-limb two's complement values
+static void toom3_evaluate(limb* p1, limb* pm1, limb* pm2, const limb* x, int k, int s) {
+    int w = k + 2;
+    fill(pm1, pm1 + w, 0);
+    pm1[k] = limbs_add(pm1, x, k, x + 2 * k, s);  // x0 + x2
+    limbs_add(p1, pm1, w, x + k, k);               // x0 + x1 + x2
+    limbs_sub(pm1, pm1, w, x + k, k);              // x0 - x1 + x2
+    limbs_add(pm2, pm1, w, x + 2 * k, s);          // x0 - x1 + 2 x2
+    tc_shl1(pm2, w);                               // 2 x0 - 2 x1 + 4 x2
+    limbs_sub(pm2, pm2, w, x, k);                  // x0 - 2 x1 + 4 x2
+}
+
+// out (W limbs, two's complement) = x * y for (k + 2)-limb two's complement x, y
+static void toom3_signed_mul(limb* out, int W, limb* x, limb* y, int k, limb* ws) {
+    int w = k + 2;
+    bool neg = false;
+    if (tc_negative(x, w))
+        tc_negate(x, w), neg = !neg;
+    if (tc_negative(y, w))
+        tc_negate(y, w), neg = !neg;
+    limbs_mul(out, x, k + 1, y, k + 1, ws);
+    fill(out + 2 * k + 2, out + W, 0);
+    if (neg)
+        tc_negate(out, W);
+}
+
+// Bodrato's interpolation sequence for the points 0, 1, -1, -2, inf
+// r holds r(0) in [0, 2k) and r(inf) in [4k, 2n); r1, rm1, rm2 are W-limb two's complement
+// values of r(1), r(-1), r(-2) and are overwritten
+static void toom3_interpolate(limb* r, limb* r1, limb* rm1, limb* rm2, int n, int k, int s, int W) {
+    limb* r0 = r;
+    limb* rinf = r + 4 * k;
+    fill(r + 2 * k, r + 4 * k, 0);
+
+    limbs_sub(rm2, rm2, W, r1, W);    // r3 = (r(-2) - r(1)) / 3
+    tc_divexact3(rm2, W);
+    limbs_sub(r1, r1, W, rm1, W);     // r1 = (r(1) - r(-1)) / 2
+    tc_sar1(r1, W);
+    limbs_sub(rm1, rm1, W, r0, 2 * k);  // r2 = r(-1) - r(0)
+    limbs_sub(rm2, rm1, W, rm2, W);   // r3 = (r2 - r3) / 2 + 2 r(inf)
+    tc_sar1(rm2, W);
+    limbs_add(rm2, rm2, W, rinf, 2 * s);
+    limbs_add(rm2, rm2, W, rinf, 2 * s);
+    limbs_add(rm1, rm1, W, r1, W);    // r2 = r2 + r1 - r(inf)
+    limbs_sub(rm1, rm1, W, rinf, 2 * s);
+    limbs_sub(r1, r1, W, rm2, W);     // r1 = r1 - r3
+
+    // Recompose; every coefficient is now non-negative and its high limbs beyond 2n are zero
+    limbs_add(r + k, r + k, 2 * n - k, r1, min(W, 2 * n - k));
+    limbs_add(r + 2 * k, r + 2 * k, 2 * n - 2 * k, rm1, min(W, 2 * n - 2 * k));
+    limbs_add(r + 3 * k, r + 3 * k, 2 * n - 3 * k, rm2, min(W, 2 * n - 3 * k));
+}
+
+// Toom-Cook 3-way: five half-size products instead of nine
+static void mul_toom3(limb* r, const limb* a, const limb* b, int n, limb* ws) {
+    int k = (n + 2) / 3, s = n - 2 * k;
+    int w = k + 2, W = 2 * k + 4;
+    limb* p1 = ws;
+    limb* q1 = p1 + w;
+    limb* pm1 = q1 + w;
+    limb* qm1 = pm1 + w;
+    limb* pm2 = qm1 + w;
+    limb* qm2 = pm2 + w;
+    limb* r1 = qm2 + w;
+    limb* rm1 = r1 + W;
+    limb* rm2 = rm1 + W;
+    limb* next = rm2 + W;
+
+    toom3_evaluate(p1, pm1, pm2, a, k, s);
+    toom3_evaluate(q1, qm1, qm2, b, k, s);
+
+    toom3_signed_mul(r1, W, p1, q1, k, next);
+    toom3_signed_mul(rm1, W, pm1, qm1, k, next);
+    toom3_signed_mul(rm2, W, pm2, qm2, k, next);
+
+    limbs_mul(r, a, k, b, k, next);                       // r(0) -> r[0..2k)
+    limbs_mul(r + 4 * k, a + 2 * k, s, b + 2 * k, s, next);  // r(inf) -> r[4k..2n)
+    toom3_interpolate(r, r1, rm1, rm2, n, k, s, W);
+}
+
+// out (W limbs) = x^2 for a (k + 2)-limb two's complement x; the square is never negative
+static void toom3_sqr_point(limb* out, int W, limb* x, int k, limb* ws) {
+    int w = k + 2;
+    if (tc_negative(x, w))
+        tc_negate(x, w);
+    limbs_sqr(out, x, k + 1, ws);
+    fill(out + 2 * k + 2, out + W, 0);
+}
+
+// Toom-3 square: one evaluation instead of two, five half-size squares
+static void sqr_toom3(limb* r, const limb* a, int n, limb* ws) {
+    int k = (n + 2) / 3, s = n - 2 * k;
+    int w = k + 2, W = 2 * k + 4;
+    limb* p1 = ws;
+    limb* pm1 = p1 + w;
+    limb* pm2 = pm1 + w;
+    limb* r1 = pm2 + w;
+    limb* rm1 = r1 + W;
+    limb* rm2 = rm1 + W;
+    limb* next = rm2 + W;
+
+    toom3_evaluate(p1, pm1, pm2, a, k, s);
+    toom3_sqr_point(r1, W, p1, k, next);
+    toom3_sqr_point(rm1, W, pm1, k, next);
+    toom3_sqr_point(rm2, W, pm2, k, next);
+
+    limbs_sqr(r, a, k, next);
+    limbs_sqr(r + 4 * k, a + 2 * k, s, next);
+    toom3_interpolate(r, r1, rm1, rm2, n, k, s, W);
+}
+
+void limbs_sqr(limb* r, const limb* a, int n, limb* ws) {
+    if (n < karatsuba_threshold)
+        limbs_sqr_basecase(r, a, n);
+    else if (n < toom3_threshold)
+        sqr_karatsuba(r, a, n, ws);
+    else
+        sqr_toom3(r, a, n, ws);
+}
+
+void limbs_mul(limb* r, const limb* a, int na, const limb* b, int nb, limb* ws) {
+    if (na < nb) {
+        swap(a, b);
+        swap(na, nb);
+    }
+    if (nb < karatsuba_threshold) {
+        limbs_mul_basecase(r, a, na, b, nb);
+        return;
+    }
+    if (na == nb) {
+        if (na < toom3_threshold)
+            mul_karatsuba(r, a, b, na, ws);
+        else
+            mul_toom3(r, a, b, na, ws);
+        return;
+    }
+
+    // Unbalanced: cut a into nb-limb chunks and accumulate
+    limb* t = ws;
+    ws += 2 * nb;
+    fill(r, r + na + nb, 0);
+    for (int off = 0; off < na; off += nb) {
+        int len = min(nb, na - off);
+        limbs_mul(t, a + off, len, b, nb, ws);
+        limbs_add(r + off, r + off, na + nb - off, t, len + nb);
+    }
+}
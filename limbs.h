@@ -0,0 +1,39 @@
+// Low-level arithmetic on little-endian base 2^32 limb arrays
+// No sign, no allocation: the caller owns every buffer, including the scratch space
+// Reference: https://gmplib.org/manual/Multiplication-Algorithms
+// Reference: M. Bodrato, "Towards Optimal Toom-Cook Multiplication for Univariate and Multivariate Polynomials" (2007)
+
+#ifndef LIMBS_H
+#define LIMBS_H
+
+#include <cstdint>
+
+using limb = uint32_t;    // Binary limb, base 2^32
+using dlimb = uint64_t;   // Double-width intermediate for limb products
+constexpr int limb_bits = 32;
+
+constexpr int karatsuba_threshold = 32;  // Limbs; below this schoolbook wins
+constexpr int toom3_threshold = 128;     // Limbs; from here Toom-3 beats Karatsuba
+
+// r = a + b (na >= nb), returns the carry out; r may alias a or b
+limb limbs_add(limb* r, const limb* a, int na, const limb* b, int nb);
+// r = a - b (na >= nb), returns the borrow out; r may alias a or b
+limb limbs_sub(limb* r, const limb* a, int na, const limb* b, int nb);
+// Compare a and b; leading zero limbs are allowed
+int limbs_cmp(const limb* a, int na, const limb* b, int nb);
+
+// r[0..na+nb) = a * b, schoolbook
+void limbs_mul_basecase(limb* r, const limb* a, int na, const limb* b, int nb);
+// r[0..na+nb) = a * b, Karatsuba / Toom-3 above the thresholds; r must not overlap a or b
+void limbs_mul(limb* r, const limb* a, int na, const limb* b, int nb, limb* scratch);
+// Scratch limbs needed by limbs_mul for these operand sizes
+int limbs_mul_scratch(int na, int nb);
+
+// r[0..2n) = a^2, schoolbook with each cross product computed once
+void limbs_sqr_basecase(limb* r, const limb* a, int n);
+// r[0..2n) = a^2, Karatsuba / Toom-3 squaring above the multiplication thresholds; r must not overlap a
+void limbs_sqr(limb* r, const limb* a, int n, limb* scratch);
+// Scratch limbs needed by limbs_sqr for an n-limb operand
+int limbs_sqr_scratch(int n);
+
+#endif
@@ -7,226 +7,488 @@
 #include <bitset>
 #include <sstream>
 #include <climits>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <cassert>
 #include "BigInt.h"
+#include "Montgomery.h"
+#include "FixedInt.h"
+#include "FixedBase.h"
+#include "Barrett.h"
+#include "ModExp.h"
+#include "chacha20.h"
+#include "UniformBigInt.h"
 
 using namespace std;
 
-// AModular exponentiation function
-// Computes (base^exponent) % mod efficiently using binary exponentiation + sliding window
-// This handles large numbers using BigInt for 512+ bit arithmetic
-BigInt modular_exponentiation(BigInt base, BigInt exponent,const BigInt& mod) {
-    // Special cases
-    if (mod == 1) return BigInt(0);
-    if (exponent.isZero()) return BigInt(1) % mod;
-
-    // Ensure base is within mod
-    base %= mod;
-    if (base.isZero()) return BigInt(0);
-
-    // Convert exponent to binary representation, then store reversed bits in a vector
-    std::vector<int> bits;
-    {
-        BigInt e = exponent;
-        while (!e.isZero()) {
-            int bit = e % 2;
-            bits.push_back(bit);
-            e /= 2;
+//Generate random BigInt with exactly the specified number of bits from a caller-owned generator
+// Any 64-bit UniformRandomBitGenerator works: ChaChaRng, or a seeded mt19937_64 for reproducible runs
+template <class Rng>
+BigInt generate_random_bits(int bits, Rng& gen) {
+    // MSB = 1 to ensure correct bit length
+    return BigInt::random_bits(gen, bits, true);
+}
+
+//Generate random BigInt with specified number of bits
+// Draws from this thread's ChaCha20 generator: no seeding or system call per number
+BigInt generate_random_bits(int bits) {
+    return generate_random_bits(bits, ChaChaRng::thread_instance());
+}
+
+// Helper threads for parallel Miller-Rabin rounds, started on first use and kept until exit:
+// a candidate pays neither thread creation nor generator seeding
+// One candidate at a time has them; a caller that finds them busy runs its rounds alone
+class RoundHelpers {
+public:
+    static RoundHelpers& instance() {
+        static RoundHelpers helpers;
+        return helpers;
+    }
+
+    // job on the calling thread and on up to helpers other threads; returns once every call has returned
+    void run(const function<void()>& job, int helpers) {
+        unique_lock<mutex> owner(batch, defer_lock);
+        if (helpers <= 0 || !owner.try_lock()) {
+            job();
+            return;
         }
-        if (bits.empty()) {
-            bits.push_back(0);
+        {
+            lock_guard<mutex> lk(mtx);
+            helpers = min(helpers, max_helpers);
+            while ((int)threads.size() < helpers)
+                threads.emplace_back(&RoundHelpers::helper_loop, this);
+            current = &job;
+            slots = active = helpers;
+            generation++;
         }
+        wake.notify_all();
+        job();
+
+        unique_lock<mutex> lk(mtx);
+        finished.wait(lk, [&] { return active == 0; });
+        current = nullptr;
     }
 
-    const int W = 4; //Optimal window size
-    const int MAX_ODD = (1 << W);    // 2^W
-    std::vector<BigInt> pre(MAX_ODD); // Precomputed a^u for odd u
+    ~RoundHelpers() {
+        {
+            lock_guard<mutex> lk(mtx);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (thread& t : threads)
+            t.join();
+    }
 
-    pre[1] = base;
-    BigInt base2 = (base * base) % mod;
-    for (int e = 3; e < MAX_ODD; e += 2) {
-        pre[e] = (pre[e - 2] * base2) % mod;
+private:
+    RoundHelpers() : max_helpers(max(1, (int)thread::hardware_concurrency() - 1)) {}
+
+    void helper_loop() {
+        unsigned long long seen = 0;
+        unique_lock<mutex> lk(mtx);
+        while (true) {
+            wake.wait(lk, [&] { return stopping || generation != seen; });
+            if (stopping)
+                return;
+            seen = generation;
+            if (slots == 0)
+                continue;  // Job already has all the helpers it asked for
+            slots--;
+            const function<void()>* job = current;
+            lk.unlock();
+            (*job)();
+            lk.lock();
+            if (--active == 0)
+                finished.notify_one();
+        }
     }
 
-    BigInt result = 1;
-    int i = (int)bits.size() - 1;   // index bit cao nhất
+    const int max_helpers;
+    vector<thread> threads;
+    mutex batch;                      // Held by the candidate using the helpers
+    mutex mtx;                        // Guards everything below
+    condition_variable wake;          // New job or shutdown
+    condition_variable finished;      // Last helper finished the job
+    const function<void()>* current = nullptr;
+    unsigned long long generation = 0;  // Bumped once per job so a helper never runs one twice
+    int slots = 0;                    // Helpers still to pick up the current job
+    int active = 0;                   // Helpers that have not finished it
+    bool stopping = false;
+};
 
-    // Compute result using sliding window
-    while (i >= 0) {
-        if (bits[i] == 0) {
-            result = (result * result) % mod;
-            --i;
+// Per-candidate Miller-Rabin state: n - 1 = 2^r * d, the Montgomery forms of 1 and n - 1 and the
+// witness range are computed once here instead of in every round
+// round() is const, so one context serves every thread running rounds of the same candidate
+template <class Mont>
+class MillerRabin {
+public:
+    using Value = typename Mont::Value;
+
+    explicit MillerRabin(const Mont& mont)
+        : mont(mont), d(mont.modulus() - 1), witness_range(mont.modulus() - 3),
+          one(mont.one()), minus_one(mont.to_mont(d)) {
+        r = d.lowestSetBit();
+        d >>= r;
+    }
+
+    // True when the witness a in [2, n - 2] does not prove n composite
+    // a fits one limb, so a^d is squarings and single-limb multiplies that never leave Montgomery form
+    bool round(limb a) const {
+        Value x = one;
+        for (int i = d.bitLength() - 1; i >= 0; i--) {
+            mont.sqr(x, x);
+            if (d.testBit(i))
+                mont.mul_small(x, x, a);
         }
-        else {
-            int l = std::max(0, i - W + 1);
-            int j = l;
+        if (x == one || x == minus_one)
+            return true;
 
-            while (j < i && bits[j] == 0) {
-                ++j;
-            }
-            int length = i - j + 1;
+        // Repeated squaring stays in Montgomery form
+        for (int j = 0; j < r - 1; j++) {
+            mont.sqr(x, x);
+            if (x == minus_one)
+                return true;
+        }
+        return false;
+    }
 
-            int u = 0;
-            for (int k = i; k >= j; --k) {
-                u = (u << 1) | bits[k];
-            }
+    // 31 random bits mapped into [2, n - 2], so the witness always fits one limb
+    limb witness(ChaChaRng& gen) const {
+        BigInt a = (long long)(gen() >> 33);
+        if (!(a < witness_range))
+            a %= witness_range;
+        return (limb)(a + 2).longValue();
+    }
+
+    // k rounds spread over threads (the calling thread and RoundHelpers), each drawing witnesses
+    // from its own ChaChaRng; every thread stops at the first composite witness or once cancel is set
+    // True only when all k rounds ran and passed
+    bool run(int k, int threads, const atomic<bool>* cancel) const {
+        atomic<int> next{0};           // Rounds handed out
+        atomic<int> passed{0};         // Rounds finished without a composite witness
+        atomic<bool> composite{false};
 
-            for (int k = 0; k < length; ++k) {
-                result = (result * result) % mod;
+        auto worker = [&]() {
+            ChaChaRng& gen = ChaChaRng::thread_instance();
+            while (!composite.load(memory_order_relaxed) && !(cancel && cancel->load(memory_order_relaxed))) {
+                if (next++ >= k)
+                    return;
+                if (round(witness(gen)))
+                    ++passed;
+                else
+                    composite.store(true, memory_order_relaxed);
             }
+        };
+
+        RoundHelpers::instance().run(worker, min(threads, k) - 1);
+        return passed == k;
+    }
 
-            result = (result * pre[u]) % mod;
+private:
+    const Mont& mont;
+    BigInt d;              // Odd part of n - 1
+    int r;                 // n - 1 = 2^r * d
+    BigInt witness_range;  // n - 3: witnesses are 2 + (w mod (n - 3))
+    Value one, minus_one;  // 1 and n - 1 in Montgomery form
+};
+
+// Miller-Rabin primality test for BigInt
+// If cancel is given and becomes true, the test gives up between rounds and reports composite
+// threads > 1 runs the rounds in parallel; the first composite witness stops all of them
+bool miller_rabin_test(BigInt n, int k = 20, const atomic<bool>* cancel = nullptr, int threads = 1) {
+    if (n == 2 || n == 3) return true;
+    if (n < 2 || !n.testBit(0)) return false;
+
+    // One Montgomery context (fixed-width for DH group sizes) shared by every round of this candidate
+    return with_montgomery(n, [&](const auto& mont) {
+        MillerRabin<typename std::decay<decltype(mont)>::type> mr(mont);
+        return mr.run(k, threads, cancel);
+    });
+}
+
+// Jacobi symbol (a / n) for odd n > 0, by the binary algorithm
+int jacobi(BigInt a, BigInt n) {
+    a = a % n;
+    if (a < 0) a += n;
+    int result = 1;
+    while (!a.isZero()) {
+        int s = a.lowestSetBit();
+        a >>= s;
+        int r = n % 8;
+        if ((s & 1) && (r == 3 || r == 5)) result = -result;
+        swap(a, n);
+        if (a % 4 == 3 && n % 4 == 3) result = -result;
+        a = a % n;
+    }
+    return n == 1 ? result : 0;
+}
 
-            i = j - 1;
+// True when n >= 0 is a perfect square (Newton's integer square root)
+bool is_perfect_square(const BigInt& n) {
+    if (n < 2) return n >= 0;
+    BigInt x = BigInt(1) << ((n.bitLength() + 1) / 2);  // x >= sqrt(n)
+    while (true) {
+        BigInt y = (x + n / x) >> 1;
+        if (!(y < x)) break;
+        x = y;
+    }
+    return x * x == n;
+}
+
+// Strong Lucas probable-prime test with P = 1 and Q = (1 - D) / 4, for (D / n) = -1
+// n + 1 = 2^s * d; passes when U_d = 0 or V_(d 2^r) = 0 for some r < s (all mod n)
+// U, V and Q^k run in Montgomery form: doubling is two squarings and a product, adding 1 is
+// single-limb multiplies and halvings
+// Reference: R. Baillie, S. Wagstaff, "Lucas Pseudoprimes" (1980)
+template <class Mont>
+bool strong_lucas_test(const Mont& mont, long long D, long long Q) {
+    using Value = typename Mont::Value;
+    // x = c * x for a small signed c
+    auto mul_signed = [&](Value& x, long long c, const Value& zero) {
+        mont.mul_small(x, x, (limb)(c < 0 ? -c : c));
+        if (c < 0) mont.sub(x, zero, x);
+    };
+
+    BigInt d = mont.modulus() + 1;
+    int s = d.lowestSetBit();
+    d >>= s;
+
+    Value zero = mont.to_mont(BigInt(0));
+    Value U = mont.one(), V = mont.one(), Qk = mont.to_mont(BigInt(Q));  // U_1 = 1, V_1 = P, Q^1
+    Value t;
+    for (int i = d.bitLength() - 2; i >= 0; i--) {
+        // k -> 2k: U_2k = U_k V_k, V_2k = V_k^2 - 2 Q^k
+        mont.mul(U, U, V);
+        mont.sqr(V, V);
+        mont.add(t, Qk, Qk);
+        mont.sub(V, V, t);
+        mont.sqr(Qk, Qk);
+        if (d.testBit(i)) {
+            // k -> k + 1: U_k+1 = (P U_k + V_k) / 2, V_k+1 = (D U_k + P V_k) / 2
+            t = U;
+            mul_signed(t, D, zero);
+            mont.add(U, U, V);
+            mont.half(U, U);
+            mont.add(V, V, t);
+            mont.half(V, V);
+            mul_signed(Qk, Q, zero);
         }
     }
+    if (U == zero || V == zero)
+        return true;
 
-    return result;
+    for (int r = 1; r < s; r++) {
+        mont.sqr(V, V);
+        mont.add(t, Qk, Qk);
+        mont.sub(V, V, t);
+        if (V == zero)
+            return true;
+        mont.sqr(Qk, Qk);
+    }
+    return false;
 }
 
-// Generate seed using multiple entropy sources
+// Baillie-PSW: a strong test to base 2, then a strong Lucas test with Selfridge's parameters
+// (first D in 5, -7, 9, -11, ... with (D / n) = -1); no composite is known to pass both
+// Costs about three exponentiations, against one per round for Miller-Rabin
+bool bpsw_test(const BigInt& n) {
+    if (n == 2 || n == 3) return true;
+    if (n < 2 || !n.testBit(0)) return false;
 
-unsigned long long generate_cryptographic_seed() {
-    random_device rd;
-    // Collect multiple random values from random_device
-    unsigned long long seed1 = rd();
-    unsigned long long seed2 = rd();
-    unsigned long long seed3 = rd();
-    
-    // Combine with time and clock for additional entropy
-    unsigned long long time_seed = static_cast<unsigned long long>(time(nullptr));
-    unsigned long long clock_seed = static_cast<unsigned long long>(clock());
-    
-    // XOR all sources together to combine entropy
-    // Using XOR preserves entropy better than addition
-    return seed1 ^ (seed2 << 16) ^ (seed3 << 32) ^ time_seed ^ clock_seed;
+    return with_montgomery(n, [&](const auto& mont) {
+        MillerRabin<typename std::decay<decltype(mont)>::type> mr(mont);
+        if (!mr.round(2))
+            return false;
+
+        // No D exists for squares; some of them (e.g. 1093^2) are strong pseudoprimes to base 2
+        if (is_perfect_square(n))
+            return false;
+        long long D = 5;
+        while (true) {
+            int j = jacobi(BigInt(D), n);
+            if (j == -1) break;
+            if (j == 0) return BigInt(D).abs() == n;  // |D| shares a factor with n
+            D = D > 0 ? -(D + 2) : -D + 2;
+        }
+        return strong_lucas_test(mont, D, (1 - D) / 4);
+    });
 }
 
-//Generate random BigInt with specified number of bits
-BigInt generate_random_bits(int bits) {
-    if (bits <= 0) {
-        return BigInt(0);
-    }
-    
-    // Generate cryptographic seed with multiple entropy sources
-    unsigned long long seed = generate_cryptographic_seed();
-    
-    // Use multiple random_device instances for better entropy
-    random_device rd1, rd2, rd3;
-    seed ^= (static_cast<unsigned long long>(rd1()) << 0);
-    seed ^= (static_cast<unsigned long long>(rd2()) << 16);
-    seed ^= (static_cast<unsigned long long>(rd3()) << 32);
-    
-    // Create generator with combined seed
-    mt19937_64 gen(seed);
-    uniform_int_distribution<unsigned long long> dis(0, ULLONG_MAX);
-    
-    // Build random number bit by bit
-    // Start with MSB = 1 to ensure correct bit length
-    BigInt result = 1;
-    
-    // Generate remaining bits
-    for (int i = 1; i < bits; i++) {
-        result = result * 2;
-        // Use random bit from generator
-        if (dis(gen) % 2 == 1) {
-            result = result + 1;
+// Which primality test a search runs on its candidates
+enum class PrimalityEngine {
+    miller_rabin,  // rounds random witnesses
+    bpsw           // Baillie-PSW, then confirm_rounds random Miller-Rabin witnesses
+};
+
+struct PrimalityPolicy {
+    PrimalityEngine engine = PrimalityEngine::miller_rabin;
+    int rounds = 20;         // Miller-Rabin witnesses per candidate
+    int confirm_rounds = 0;  // Extra Miller-Rabin witnesses after BPSW accepts, 0 for none
+};
+
+// Primality by the policy's engine; cancel as in miller_rabin_test
+bool is_probable_prime(const BigInt& n, const PrimalityPolicy& policy, const atomic<bool>* cancel = nullptr) {
+    if (policy.engine == PrimalityEngine::miller_rabin)
+        return miller_rabin_test(n, policy.rounds, cancel);
+    if (cancel && cancel->load(memory_order_relaxed))
+        return false;
+    return bpsw_test(n) && (policy.confirm_rounds <= 0 || miller_rabin_test(n, policy.confirm_rounds, cancel));
+}
+
+// Odd primes below bound (sieve of Eratosthenes)
+std::vector<int> odd_primes_below(int bound) {
+    std::vector<char> composite(bound, 0);
+    std::vector<int> primes;
+    for (int i = 3; i < bound; i += 2) {
+        if (composite[i]) continue;
+        primes.push_back(i);
+        for (long long j = 1LL * i * i; j < bound; j += 2 * i) {
+            composite[j] = 1;
         }
     }
-    
-    random_device rd_extra;
-    for (int i = 0; i < 4; i++) {
-        unsigned long long extra = rd_extra();
-        // Mix extra entropy into result by adding small random values
-        BigInt extra_big = BigInt(extra);
-        result = result + extra_big;
-        // Keep within bit bounds by using modulo
-        BigInt max_val = BigInt(1);
-        for (int j = 0; j < bits; j++) {
-            max_val = max_val * 2;
-        }
-        result = result % max_val;
+    return primes;
+}
+
+// Incremental sieve over safe-prime candidates q, q + 2, q + 4, ... (p = 2q + 1)
+// A candidate is rejected when q or 2q + 1 is divisible by an odd prime below the bound
+// The table keeps (window start) mod s for every sieve prime s, so moving to the next
+// window only updates residues instead of dividing the BigInt again
+class SafePrimeSieve {
+public:
+    SafePrimeSieve(int bound, int window = 4096) : primes(odd_primes_below(bound)), window(window) {}
 
-        BigInt min_val = BigInt(1);
-        for (int j = 0; j < bits - 1; j++) {
-            min_val = min_val * 2;
+    // Start a new run at an odd q; only the survivors of next() need Miller-Rabin
+    void reset(const BigInt& start) {
+        base = start;
+        active = 0;
+        residues.resize(primes.size());
+        for (size_t i = 0; i < primes.size(); i++) {
+            // A prime equal to q (tiny bit sizes only) must not reject itself
+            if (!(BigInt(primes[i]) < start)) break;
+            residues[i] = start % primes[i];
+            active++;
         }
-        if (result < min_val) {
-            result = result + min_val;
+        sieve_window();
+    }
+
+    BigInt next() {
+        while (true) {
+            while (pos < window && composite[pos]) {
+                pos++;
+            }
+            if (pos < window) {
+                BigInt q = base + BigInt(2LL * pos);
+                pos++;
+                return q;
+            }
+            base += BigInt(2LL * window);
+            for (int i = 0; i < active; i++) {
+                residues[i] = (int)((residues[i] + 2LL * window) % primes[i]);
+            }
+            sieve_window();
         }
     }
-    
-    return result;
-}
 
-// Miller-Rabin primality test for BigInt
-bool miller_rabin_test(BigInt n, int k = 20) {
-    if (n == 2 || n == 3) return true;
-    if (n < 2 || n % 2 == 0) return false;
-    
-    // Write n-1 as 2^r * d
-    BigInt d = n - 1;
-    int r = 0;
-    while (d % 2 == 0) {
-        d = d / 2;
-        r++;
+private:
+    void sieve_window() {
+        composite.assign(window, 0);
+        pos = 0;
+        for (int i = 0; i < active; i++) {
+            long long s = primes[i], r = residues[i], inv2 = (s + 1) / 2;
+            // q = base + 2k = 0 (mod s)  =>  k = -r / 2 (mod s)
+            for (long long k = (s - r) % s * inv2 % s; k < window; k += s) {
+                composite[k] = 1;
+            }
+            // 2q + 1 = 0 (mod s)  =>  q = (s - 1) / 2  =>  k = ((s - 1) / 2 - r) / 2 (mod s)
+            for (long long k = ((s - 1) / 2 - r + s) % s * inv2 % s; k < window; k += s) {
+                composite[k] = 1;
+            }
+        }
     }
-    
-    // Witness loop - test k times
-    random_device rd;
-    mt19937_64 gen(rd());
-    
-    for (int i = 0; i < k; i++) {
-        BigInt a = generate_random_bits(32) % (n - 3) + 2;
-        BigInt x = modular_exponentiation(a, d, n);
-        
-        if (x == 1 || x == n - 1)
+
+    std::vector<int> primes;     // Odd sieve primes below the bound
+    std::vector<int> residues;   // base mod primes[i]
+    int active = 0;              // Number of primes in use (all primes below q)
+    BigInt base;                 // Candidate at offset 0 of the current window
+    std::vector<char> composite; // composite[k]: base + 2k is rejected
+    int window;                  // Candidates per window
+    int pos = 0;                 // Next offset to look at
+};
+
+// State shared by the workers of one safe-prime search
+struct SafePrimeSearch {
+    atomic<bool> found{false};   // Set by the first worker that finds a safe prime, cancels the rest
+    atomic<int> attempts{0};     // Miller-Rabin candidates tested, summed over all workers
+    mutex mtx;                   // Guards result and console output
+    BigInt result;
+};
+
+// One independent candidate stream: its own RNG state and its own sieve
+void safe_prime_worker(int bit_size, int sieve_bound, PrimalityPolicy policy, SafePrimeSearch& search) {
+    ChaChaRng& gen = ChaChaRng::thread_instance();
+    SafePrimeSieve sieve(sieve_bound);
+    BigInt limit = BigInt(1) << (bit_size - 1);  // q must stay below 2^(bit_size-1)
+    BigInt q = limit;
+    
+    while (!search.found.load(memory_order_relaxed)) {
+        // Generate random odd number of bit_size bits, then walk the sieve from it
+        if (!(q < limit)) {
+            BigInt start = BigInt::random_bits(gen, bit_size - 1, true, true);
+            sieve.reset(start);
+        }
+        q = sieve.next();
+        if (!(q < limit)) {
             continue;
+        }
         
-        bool composite = true;
-        for (int j = 0; j < r - 1; j++) {
-            x = modular_exponentiation(x, BigInt(2), n);
-            if (x == n - 1) {
-                composite = false;
-                break;
-            }
+        int attempts = ++search.attempts;
+        if (attempts % 10 == 0) {
+            lock_guard<mutex> lock(search.mtx);
+            cout << "  Attempt " << attempts << "..." << endl;
         }
         
-        if (composite)
-            return false;
+        // Check if q is prime
+        if (is_probable_prime(q, policy, &search.found)) {
+            // Check if p = 2q + 1 is also prime (safe prime)
+            BigInt p = (q << 1) + 1;
+            if (is_probable_prime(p, policy, &search.found)) {
+                lock_guard<mutex> lock(search.mtx);
+                if (!search.found.exchange(true)) {
+                    search.result = p;
+                }
+                return;
+            }
+        }
     }
-    
-    return true;
 }
 
 // Generate a safe prime number of specified bit size
 // A safe prime is a prime p where (p-1)/2 is also prime
+// Candidates are pre-filtered by trial division of q and 2q + 1 with every prime below sieve_bound
+// With threads > 1 the search runs that many independent streams; the first hit cancels the others
+// policy picks the primality engine (Miller-Rabin by default, or BPSW) and its confirmation rounds
 // Minimum 512 bits 
-BigInt generate_safe_prime(int bit_size) {
+BigInt generate_safe_prime(int bit_size, int threads = 1, int sieve_bound = 1 << 16,
+                           const PrimalityPolicy& policy = PrimalityPolicy()) {
     cout << "Generating " << bit_size << "-bit safe prime (this may take several minutes)..." << endl;
     
-    int attempts = 0;
-    while (true) {
-        attempts++;
-        if (attempts % 10 == 0) {
-            cout << "  Attempt " << attempts << "..." << endl;
+    SafePrimeSearch search;
+    if (threads <= 1) {
+        safe_prime_worker(bit_size, sieve_bound, policy, search);
+    } else {
+        vector<thread> workers;
+        for (int t = 0; t < threads; t++) {
+            workers.emplace_back(safe_prime_worker, bit_size, sieve_bound, policy, ref(search));
         }
-        
-        // Generate random odd number of bit_size bits
-        BigInt q = generate_random_bits(bit_size - 1);
-        if (q % 2 == 0) {
-            q = q + 1;
-        }
-        
-        // Check if q is prime
-        if (miller_rabin_test(q)) {
-            // Check if p = 2q + 1 is also prime (safe prime)
-            BigInt p = q * 2 + 1;
-            if (miller_rabin_test(p)) {
-                cout << "Safe prime found after " << attempts << " attempts!" << endl;
-                return p;
-            }
+        for (thread& w : workers) {
+            w.join();
         }
     }
+    
+    cout << "Safe prime found after " << search.attempts << " attempts!" << endl;
+    return search.result;
 }
 
 bool validate_prime(BigInt p) {
@@ -235,52 +497,21 @@ bool validate_prime(BigInt p) {
         return false;
     }
     // p must be odd
-    if (p % 2 == 0) {
+    if (!p.testBit(0)) {
         return false;
     }
     return true;
 }
 
 //Generate random BigInt in range [min, max]
+// Uniform by rejection sampling (UniformBigIntDistribution): no modulo bias and no division
 BigInt generate_random_in_range(BigInt min_val, BigInt max_val) {
     if (max_val < min_val) {
         // Invalid range, return min_val
         return min_val;
     }
     
-    if (min_val == max_val) {
-        // Range is single value
-        return min_val;
-    }
-    
-    BigInt range = max_val - min_val + 1;
-    
-    int approx_bits = 0;
-    BigInt test = BigInt(1);
-    while (test <= max_val && approx_bits < 1024) {
-        approx_bits++;
-        if (approx_bits < 63) {  // Use shift for small values
-            test = test * 2;
-        } else {
-
-            break;
-        }
-    }
-    
-    int bits_to_use = (approx_bits > 0) ? (approx_bits + 64) : 512;
-
-    BigInt random_value = generate_random_bits(bits_to_use);
-    
-    BigInt result = (random_value % range) + min_val;
-
-    if (result < min_val) {
-        result = min_val;
-    } else if (result > max_val) {
-
-        result = max_val;
-    }
-    
-    return result;
+    return UniformBigIntDistribution(min_val, max_val)(ChaChaRng::thread_instance());
 }
 
 // Generate a private key for Diffie-Hellman
@@ -292,20 +523,8 @@ BigInt generate_private_key(BigInt p) {
         return BigInt(2);
     }
     
-    // Private key must be in range [2, p-2]
-    BigInt min_key = BigInt(2);
-    BigInt max_key = p - 2;
-    
-    // Generate private key using rejection sampling to avoid bias
-    BigInt private_key = generate_random_in_range(min_key, max_key);
-
-    if (private_key < min_key || private_key > max_key) {
-        //cerr << "WARNING: Generated private key out of range, adjusting..." << endl;
-        BigInt range = max_key - min_key + 1;
-        private_key = (generate_random_bits(256) % range) + min_key;
-    }
-    
-    return private_key;
+    // Private key must be in range [2, p-2], drawn uniformly
+    return generate_random_in_range(BigInt(2), p - 2);
 }
 
 // D: Main function - Diffie-Hellman key exchange implementation
@@ -315,12 +534,22 @@ int main(int argc, char* argv[]) {
     cout << "================================================================" << endl;
     cout << endl;
     int bit_size = 512; 
+    int threads = max(1, (int)thread::hardware_concurrency());  // Safe-prime search workers
+    
+    if (argc > 2) {
+        threads = atoi(argv[2]);
+        if (threads < 1) {
+            cout << "Invalid thread count. Must be at least 1." << endl;
+            cout << "Usage: " << argv[0] << " [bit_size] [threads]" << endl;
+            return 1;
+        }
+    }
     
     if (argc > 1) {
         bit_size = atoi(argv[1]);
         if (bit_size != 64 && bit_size != 128 && bit_size != 256 && bit_size != 512) {
             cout << "Invalid bit size. Supported: 64, 128, 256, 512" << endl;
-            cout << "Usage: " << argv[0] << " [bit_size]" << endl;
+            cout << "Usage: " << argv[0] << " [bit_size] [threads]" << endl;
             cout << "Example: " << argv[0] << " 128" << endl;
             return 1;
         }
@@ -353,12 +582,13 @@ int main(int argc, char* argv[]) {
     }
     
     cout << "Using " << bit_size << "-bit prime" << endl;
+    cout << "Using " << threads << " thread(s) for safe-prime search" << endl;
     cout << endl;
     
     // 1. Generate safe prime p and generator g
     cout << "Step 1: Generating parameters" << endl;
     cout << "-------------------------------------------" << endl;
-    BigInt p = generate_safe_prime(bit_size);
+    BigInt p = generate_safe_prime(bit_size, threads);
     BigInt g = 2;  // Generator (commonly used value)
     
     // Validate generated prime
@@ -402,11 +632,12 @@ int main(int argc, char* argv[]) {
     // 3. Compute public keys
     cout << "Step 3: Computing public keys" << endl;
     cout << "-------------------------------------------" << endl;
+    FixedBaseExp g_pow(g, p);  // Powers of g precomputed once for this group, then multiplications only
     cout << "Alice computes A = g^a mod p..." << endl;
-    BigInt A = modular_exponentiation(g, a, p);  // Alice computes A = g^a % p
+    BigInt A = g_pow.pow(a);  // Alice computes A = g^a % p
     
     cout << "Bob computes B = g^b mod p..." << endl;
-    BigInt B = modular_exponentiation(g, b, p);  // Bob computes B = g^b % p
+    BigInt B = g_pow.pow(b);  // Bob computes B = g^b % p
     
     cout << endl;
     cout << "Alice's public key A = " << A << endl;
@@ -0,0 +1,101 @@
+// Bounded lock-free multi-producer multi-consumer queue
+// Every cell carries a sequence number that tells producers and consumers whose turn it is, so a
+// push or a pop is one compare-and-swap on its end of the ring plus a release store on the cell;
+// producers and consumers only meet on a cell when the queue is full or empty
+// Reference: D. Vyukov, "Bounded MPMC queue" (1024cores.net)
+
+#ifndef MPMC_QUEUE_H
+#define MPMC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+template <class T>
+class MpmcQueue {
+public:
+    // capacity is rounded up to a power of two
+    explicit MpmcQueue(size_t capacity) {
+        size_t n = 2;
+        while (n < capacity)
+            n *= 2;
+        mask = n - 1;
+        cells.reset(new Cell[n]);
+        for (size_t i = 0; i < n; i++)
+            cells[i].seq.store(i, std::memory_order_relaxed);
+        head.store(0, std::memory_order_relaxed);
+        tail.store(0, std::memory_order_relaxed);
+    }
+    MpmcQueue(const MpmcQueue&) = delete;
+    MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+    // Moves v in and returns true, or returns false (v untouched) when the queue is full
+    bool try_push(T& v) {
+        size_t pos = head.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = &cells[pos & mask];
+            size_t seq = cell->seq.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+            if (diff == 0) {
+                if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            } else if (diff < 0) {
+                return false;  // The cell still holds the value from one lap ago
+            } else {
+                pos = head.load(std::memory_order_relaxed);
+            }
+        }
+        cell->value = std::move(v);
+        cell->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Moves the oldest value into out and returns true, or returns false when the queue is empty
+    bool try_pop(T& out) {
+        size_t pos = tail.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = &cells[pos & mask];
+            size_t seq = cell->seq.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+            if (diff == 0) {
+                if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            } else if (diff < 0) {
+                return false;  // Not written yet
+            } else {
+                pos = tail.load(std::memory_order_relaxed);
+            }
+        }
+        out = std::move(cell->value);
+        cell->seq.store(pos + mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Values pushed and not yet popped; exact only while no push or pop is in flight
+    size_t size() const {
+        size_t h = head.load(std::memory_order_relaxed), t = tail.load(std::memory_order_relaxed);
+        return h > t ? h - t : 0;
+    }
+    size_t capacity() const { return mask + 1; }
+
+private:
+    struct Cell {
+        std::atomic<size_t> seq;
+        T value;
+    };
+
+    std::unique_ptr<Cell[]> cells;
+    size_t mask;
+    // Producers and consumers work on different cache lines
+    char pad0[64];
+    std::atomic<size_t> head;  // Next position to push
+    char pad1[64];
+    std::atomic<size_t> tail;  // Next position to pop
+    char pad2[64];
+};
+
+#endif
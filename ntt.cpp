@@ -0,0 +1,142 @@
+#include "ntt.h"
+
+namespace {
+
+const uint32_t P0 = 2013265921, G0 = 31;  // 15 * 2^27 + 1
+const uint32_t P1 = 469762049, G1 = 3;    // 7 * 2^26 + 1
+const uint32_t P2 = 2113929217, G2 = 5;   // 63 * 2^25 + 1
+const int MAX_LOG = 25;                   // Largest transform supported by all three primes
+
+uint32_t pow_mod(uint64_t b, uint64_t e, uint32_t p) {
+    uint64_t r = 1;
+    b %= p;
+    for (; e; e >>= 1) {
+        if (e & 1)
+            r = r * b % p;
+        b = b * b % p;
+    }
+    return (uint32_t)r;
+}
+
+// Garner constants
+const uint32_t INV_P0_P1 = pow_mod(P0, P1 - 2, P1);                          // p0^-1 mod p1
+const uint32_t P0_P2 = P0 % P2;                                              // p0 mod p2
+const uint32_t INV_P0P1_P2 = pow_mod((uint64_t)P0 * P1 % P2, P2 - 2, P2);    // (p0 p1)^-1 mod p2
+const uint64_t P0P1 = (uint64_t)P0 * P1;
+
+template <uint32_t P, uint32_t G>
+void ntt(vector<uint32_t>& a, bool inverse) {
+    int n = a.size();
+    for (int i = 1, j = 0; i < n; i++) {
+        int bit = n >> 1;
+        for (; j & bit; bit >>= 1)
+            j ^= bit;
+        j ^= bit;
+        if (i < j)
+            swap(a[i], a[j]);
+    }
+    vector<uint32_t> w(max(n / 2, 1));
+    for (int len = 1; len < n; len <<= 1) {
+        uint32_t wlen = pow_mod(G, (P - 1) / (2 * len), P);
+        if (inverse)
+            wlen = pow_mod(wlen, P - 2, P);
+        w[0] = 1;
+        for (int j = 1; j < len; j++)
+            w[j] = (uint32_t)((uint64_t)w[j - 1] * wlen % P);
+        for (int i = 0; i < n; i += len * 2) {
+            for (int j = 0; j < len; j++) {
+                uint32_t u = a[i + j];
+                uint32_t v = (uint32_t)((uint64_t)a[i + j + len] * w[j] % P);
+                a[i + j] = u + v < P ? u + v : u + v - P;
+                a[i + j + len] = u >= v ? u - v : u + P - v;
+            }
+        }
+    }
+    if (inverse) {
+        uint64_t inv_n = pow_mod(n, P - 2, P);
+        for (int i = 0; i < n; i++)
+            a[i] = (uint32_t)(a[i] * inv_n % P);
+    }
+}
+
+// Cyclic convolution of a and b modulo P with n points; a square (same vector) needs one forward transform
+template <uint32_t P, uint32_t G>
+vector<uint32_t> convolve(const vector<uint32_t>& a, const vector<uint32_t>& b, int n) {
+    vector<uint32_t> fa(n);
+    for (size_t i = 0; i < a.size(); i++)
+        fa[i] = a[i] % P;
+    ntt<P, G>(fa, false);
+    if (&a == &b) {
+        for (int i = 0; i < n; i++)
+            fa[i] = (uint32_t)((uint64_t)fa[i] * fa[i] % P);
+        ntt<P, G>(fa, true);
+        return fa;
+    }
+    vector<uint32_t> fb(n);
+    for (size_t i = 0; i < b.size(); i++)
+        fb[i] = b[i] % P;
+    ntt<P, G>(fb, false);
+    for (int i = 0; i < n; i++)
+        fa[i] = (uint32_t)((uint64_t)fa[i] * fb[i] % P);
+    ntt<P, G>(fa, true);
+    return fa;
+}
+
+// res += a << (32 * shift), res is large enough
+void add_shifted(vector<uint32_t>& res, const vector<uint32_t>& a, size_t shift) {
+    uint64_t carry = 0;
+    for (size_t i = 0; i < a.size() || carry; i++) {
+        uint64_t cur = (uint64_t)res[i + shift] + (i < a.size() ? a[i] : 0) + carry;
+        res[i + shift] = (uint32_t)cur;
+        carry = cur >> 32;
+    }
+}
+
+}  // namespace
+
+vector<uint32_t> multiply_ntt(const vector<uint32_t>& a, const vector<uint32_t>& b) {
+    if (a.empty() || b.empty())
+        return {};
+    size_t need = a.size() + b.size();
+
+    // Too long for one transform: split the longer operand and recombine
+    if (need > (size_t(1) << MAX_LOG)) {
+        const vector<uint32_t>& x = a.size() >= b.size() ? a : b;
+        const vector<uint32_t>& y = a.size() >= b.size() ? b : a;
+        size_t h = x.size() / 2;
+        vector<uint32_t> lo(x.begin(), x.begin() + h), hi(x.begin() + h, x.end());
+        vector<uint32_t> res(need + 1);
+        add_shifted(res, multiply_ntt(lo, y), 0);
+        add_shifted(res, multiply_ntt(hi, y), h);
+        res.resize(need);
+        return res;
+    }
+
+    int n = 1;
+    while ((size_t)n < need)
+        n <<= 1;
+    vector<uint32_t> r0 = convolve<P0, G0>(a, b, n);
+    vector<uint32_t> r1 = convolve<P1, G1>(a, b, n);
+    vector<uint32_t> r2 = convolve<P2, G2>(a, b, n);
+
+    // Garner: c = r0 + p0 * t1 + p0 * p1 * t2 < 2^91, pushed out 32 bits at a time
+    vector<uint32_t> res(need);
+    uint64_t carry = 0;  // Stays below 2^62
+    for (size_t i = 0; i < need; i++) {
+        uint64_t t1 = (uint64_t)(r1[i] + P1 - r0[i] % P1) * INV_P0_P1 % P1;
+        uint64_t s = ((uint64_t)r0[i] + (uint64_t)P0_P2 * t1) % P2;
+        uint64_t t2 = (r2[i] + P2 - s) % P2 * INV_P0P1_P2 % P2;
+
+        uint64_t v = r0[i] + P0 * t1;             // < 2^62
+        uint64_t lo = (P0P1 & 0xffffffffu) * t2;  // < 2^63
+        uint64_t hi = (P0P1 >> 32) * t2;          // < 2^61
+        uint64_t s0 = (v & 0xffffffffu) + (lo & 0xffffffffu) + (carry & 0xffffffffu);
+        res[i] = (uint32_t)s0;
+        carry = (v >> 32) + (lo >> 32) + hi + (carry >> 32) + (s0 >> 32);
+    }
+    return res;
+}
+
+vector<uint32_t> square_ntt(const vector<uint32_t>& a) {
+    return multiply_ntt(a, a);
+}
@@ -0,0 +1,22 @@
+// Number-theoretic transform multiplication
+// Three NTT-friendly primes below 2^31, recombined with Garner's CRT, so the product is exact
+// https://cp-algorithms.com/algebra/fft.html#number-theoretic-transform-ntt
+// https://cp-algorithms.com/algebra/chinese-remainder-theorem.html#garners-algorithm
+
+#ifndef NTT_HPP
+#define NTT_HPP
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+// Product of two little-endian base 2^32 limb vectors
+// Limbs are transformed as they are (no splitting): coefficients stay below n * 2^64 < p0 * p1 * p2
+// Operands beyond the largest transform (2^25 points) are split, so any size is exact
+extern vector<uint32_t> multiply_ntt(const vector<uint32_t>&, const vector<uint32_t>&);
+// a * a; one forward transform per prime instead of two
+extern vector<uint32_t> square_ntt(const vector<uint32_t>&);
+
+#endif